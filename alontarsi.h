@@ -0,0 +1,194 @@
+
+// alontarsi.h
+// This is a C++ library for searching for an Alon-Tarsi orientation of an fgraph.
+// The library is contained in one header file to enable use of inline functions.
+
+// Copyright 2017, Stephen G. Hartke
+// Licensed under the GPL version 3.
+
+
+#pragma once  // for compilers that support this
+#ifndef ALONTARSI_H__IEMOHQUOOCHEIZAHPHEI  // include guard
+#define ALONTARSI_H__IEMOHQUOOCHEIZAHPHEI
+
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstdlib>  // for abs
+#include "bitarray.h"
+#include "fgraph.h"
+#include "graphpolynomial.h"  // for coefficient_t
+
+
+/* An orientation D of G is an Alon-Tarsi orientation if outdegree(v)<f[v] for all v,
+ * and the number of spanning Eulerian subdigraphs of D with an even number of arcs differs from the number with an odd number.
+ * Alon and Tarsi showed that then G is f-choosable.
+ * In fact, the difference is, up to sign, the coefficient in the graph polynomial of the monomial with exponent outdegree(v) on x_v,
+ * so this is the same proof as the Combinatorial Nullstellensatz, but the orientation gives the exponents directly.
+ *
+ * We orient the edges one at a time by backtracking, never letting outdegree(v) reach f[v].
+ * Every orientation with the same outdegrees gives the same difference up to sign,
+ * so we only check the first orientation found for each outdegree sequence.
+ * The outdegrees determine how many edges have been oriented, and so they also determine the rest of the search;
+ * hence we record the outdegree sequences whose search failed, and do not repeat them.
+ *
+ * The difference is computed by multiplying in the arcs one at a time, similar to GraphPolynomial.
+ * The partial sums are kept as a map from the balance (indegree minus outdegree) of each vertex to the signed count of the arc subsets,
+ * and a subset is dropped once a vertex cannot return to balance 0 with its remaining arcs.
+ *
+ * The orientation is kept as a bitarray of outneighbors for each vertex, so the graph can have at most 64 vertices.
+ */
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+class AlonTarsi
+////////////////////////////////////////////////////////////////////////////////////////
+{
+public:
+    int n;
+    std::vector<int> max_outdegree;  // f[v]-1
+    std::vector<std::pair<int,int> > edges;  // in the order they are oriented
+    std::vector<bitarray> outneighbors;  // of the current orientation
+    std::vector<int> outdegree;
+    coefficient_t difference;  // the number of even minus the number of odd spanning Eulerian subdigraphs
+    unsigned long long int num_outdegree_sequences;  // the number of orientations whose difference was computed
+
+    AlonTarsi(const fGraph &G);
+
+    bool search();
+
+private:
+    std::unordered_set<std::string> failed;  // the outdegree sequences that do not lead to an Alon-Tarsi orientation
+
+    bool orient(size_t e,int slack);
+    coefficient_t eulerian_difference() const;
+};
+
+
+AlonTarsi::AlonTarsi(const fGraph &G)
+  : // initializer list
+    n(G.n),
+    max_outdegree(G.n),
+    outneighbors(G.n,0),
+    outdegree(G.n,0),
+    difference(0),
+    num_outdegree_sequences(0)
+{
+    for (int v=n-1; v>=0; v--)
+        max_outdegree[v]=G.f[v]-1;
+
+    // We use the edge order of GraphPolynomial, which keeps the number of vertices with partially oriented edges small.
+    // This helps both the backtracking, since a vertex's outdegree is settled sooner, and the computation of the difference.
+    GraphPolynomial polynomial(G);
+    edges=polynomial.edges;
+}
+
+
+bool AlonTarsi::search()
+    // Returns true if an Alon-Tarsi orientation is found, which is left in outneighbors, outdegree, and difference.
+{
+    int slack=0;  // the sum of max_outdegree[v]-outdegree[v], which must stay at least the number of edges to be oriented
+    for (int v=n-1; v>=0; v--)
+    {
+        if (max_outdegree[v]<0)
+            return false;
+        slack+=max_outdegree[v];
+    }
+
+    failed.clear();
+    return orient(0,slack);
+}
+
+
+bool AlonTarsi::orient(size_t e,int slack)
+{
+    if (slack<(int)(edges.size()-e))
+        return false;
+
+    if (e==edges.size())
+    {
+        num_outdegree_sequences++;
+        difference=eulerian_difference();
+        return (difference!=0);
+    }
+
+    std::string key(outdegree.begin(),outdegree.end());  // the outdegrees are less than 64, so they fit in chars
+    if (failed.count(key))
+        return false;
+
+    for (int direction=0; direction<2; direction++)
+    {
+        int u=(direction==0) ? edges[e].first : edges[e].second;
+        int v=(direction==0) ? edges[e].second : edges[e].first;
+        if (outdegree[u]>=max_outdegree[u])
+            continue;
+
+        outneighbors[u]|=(bitarray(1)<<v);
+        outdegree[u]++;
+        if (orient(e+1,slack-1))
+            return true;
+        outneighbors[u]&=~(bitarray(1)<<v);
+        outdegree[u]--;
+    }
+
+    failed.insert(key);
+    return false;
+}
+
+
+coefficient_t AlonTarsi::eulerian_difference() const
+{
+    typedef std::unordered_map<std::string,coefficient_t> Subsets;
+
+    std::vector<int> remaining(n,0);  // the number of arcs at v that have not been multiplied in
+    for (size_t e=0; e<edges.size(); e++)
+    {
+        remaining[edges[e].first]++;
+        remaining[edges[e].second]++;
+    }
+
+    Subsets subsets, next;
+    subsets[std::string(n,0)]=1;  // the empty subdigraph is Eulerian and even
+
+    for (size_t e=0; e<edges.size(); e++)
+    {
+        int tail=edges[e].first;
+        int head=edges[e].second;
+        if (!(outneighbors[tail] & (bitarray(1)<<head)))
+            std::swap(tail,head);
+        remaining[tail]--;
+        remaining[head]--;
+
+        next.clear();
+        for (Subsets::iterator it=subsets.begin(); it!=subsets.end(); ++it)
+        {
+            if (it->second==0)
+                continue;  // the subsets cancelled
+
+            std::string balance=it->first;
+
+            // without the arc
+            if ((abs(balance[tail])<=remaining[tail]) && (abs(balance[head])<=remaining[head]))
+                next[balance]+=it->second;
+
+            // with the arc, which changes the parity
+            balance[tail]--;
+            balance[head]++;
+            if ((abs(balance[tail])<=remaining[tail]) && (abs(balance[head])<=remaining[head]))
+                next[balance]-=it->second;
+        }
+        subsets.swap(next);
+
+        if (subsets.empty())
+            return 0;
+    }
+
+    // Only the balanced subsets are left.
+    Subsets::iterator it=subsets.begin();
+    return (it==subsets.end()) ? 0 : it->second;
+}
+
+
+#endif  // ALONTARSI_H__IEMOHQUOOCHEIZAHPHEI
@@ -0,0 +1,266 @@
+
+// automorphism.h
+// This is a C++ library for computing the automorphism group of a graph with an f-vector,
+// and for using it to skip symmetric colorability classes in the search for a bad list assignment.
+// The library is contained in one header file to enable use of inline functions.
+
+// Copyright 2017, Stephen G. Hartke
+// Licensed under the GPL version 3.
+
+
+#pragma once  // for compilers that support this
+#ifndef AUTOMORPHISM_H__EIGHOOQUAELAHNGAIPHE  // include guard
+#define AUTOMORPHISM_H__EIGHOOQUAELAHNGAIPHE
+
+
+#include <vector>
+#include <unordered_set>
+#include <mutex>
+#include "bitarray.h"
+
+
+/* An automorphism of an fgraph is a permutation of the vertices that preserves adjacency and f.
+ * If L is a bad list assignment, then so is its image under any automorphism.
+ *
+ * The group is computed along the stabilizer chain of the vertices n-1, n-2, ..., 0:
+ * G_i is the subgroup fixing each of the vertices 0..i-1.
+ * For each i from n-1 down to 0, we search for automorphisms in G_i mapping i to each vertex w>i that is not yet known
+ * to be in the orbit of i, by backtracking on the images of the remaining vertices.
+ * The automorphisms found form a generating set, and the order of the group is the product of the orbit sizes.
+ *
+ * Symmetry breaking is done on level 0 of the colorability class stack.
+ * Every colorability class on level 0 contains the highest eligible vertex v, and they are generated in a fixed order.
+ * The subtree below the class C searches exactly the list assignments that contain C and whose other classes containing v come after C.
+ * Suppose that a bad list assignment exists, and let C be the first class on level 0 whose subtree contains one, say L.
+ * If C is the image of an earlier class C' under an automorphism s, then s^-1(L) is bad and contains C',
+ * so the subtree of C' or of an even earlier class contains a bad list assignment, which is a contradiction.
+ * Hence we only need to search the first class of each orbit on level 0.
+ */
+
+
+template <typename bitarray_t>
+////////////////////////////////////////////////////////////////////////////////////////
+class AutomorphismGroup
+////////////////////////////////////////////////////////////////////////////////////////
+{
+public:
+    int n;  // number of vertices in the whole graph
+    const std::vector<bitarray_t> &neighbors;  // adjacencies in the graph
+    const std::vector<int> &f;  // the f vector of allowed list sizes
+
+    std::vector<std::vector<int> > generators;  // each is a permutation of the vertices
+    long double order;  // the number of automorphisms; a long double since it can be as large as n!
+    int num_vertex_orbits;
+
+    AutomorphismGroup(int n,const std::vector<bitarray_t> &neighbors,const std::vector<int> &f);
+
+    bitarray_t image(const std::vector<int> &perm,const bitarray_t &S) const;
+    bitarray_t orbit_of_vertex(int v) const;
+
+private:
+    std::vector<int> perm;  // the partial automorphism being built by find_automorphism
+    std::vector<int> search_order;  // the order in which find_automorphism assigns the free vertices
+
+    bool find_automorphism(int i,int w);
+    bool extend(size_t k,bitarray_t assigned,bitarray_t used);
+};
+
+
+template <typename bitarray_t>
+AutomorphismGroup<bitarray_t>::AutomorphismGroup(int n,const std::vector<bitarray_t> &neighbors,const std::vector<int> &f)
+  : // initializer list
+    n(n),
+    neighbors(neighbors),
+    f(f),
+    order(1),
+    num_vertex_orbits(0),
+    perm(n)
+{
+    for (int i=n-1; i>=0; i--)
+    {
+        // Every automorphism found so far fixes 0..i-1, and so is in G_i.
+        bitarray_t orbit=orbit_of_vertex(i);
+        for (int w=i+1; w<n; w++)
+            if (((orbit & ((bitarray_t)1<<w))==0) && find_automorphism(i,w))
+            {
+                generators.push_back(perm);
+                orbit=orbit_of_vertex(i);
+            }
+        order*=popcount(orbit);
+    }
+
+    bitarray_t remaining=((bitarray_t)1<<n)-1;
+    while (remaining!=0)
+    {
+        remaining&=~orbit_of_vertex(lowest_bit(remaining));
+        num_vertex_orbits++;
+    }
+}
+
+
+template <typename bitarray_t>
+bitarray_t AutomorphismGroup<bitarray_t>::image(const std::vector<int> &perm,const bitarray_t &S) const
+    // Returns the image of the set of vertices S under the permutation perm.
+{
+    bitarray_t result=0;
+    for (bitarray_t x=S; x!=0; x&=x-1)
+        result|=(bitarray_t)1<<perm[lowest_bit(x)];
+    return result;
+}
+
+
+template <typename bitarray_t>
+bitarray_t AutomorphismGroup<bitarray_t>::orbit_of_vertex(int v) const
+    // Returns the orbit of v under the group generated by the generators found so far.
+{
+    bitarray_t orbit=(bitarray_t)1<<v;
+    bitarray_t prev=0;
+    while (orbit!=prev)
+    {
+        prev=orbit;
+        for (size_t g=0; g<generators.size(); g++)
+            orbit|=image(generators[g],orbit);
+    }
+    return orbit;
+}
+
+
+template <typename bitarray_t>
+bool AutomorphismGroup<bitarray_t>::find_automorphism(int i,int w)
+    // Searches for an automorphism fixing 0..i-1 and mapping i to w.  If one is found, it is left in perm.
+{
+    if ((f[i]!=f[w]) || (popcount(neighbors[i])!=popcount(neighbors[w])))
+        return false;
+
+    bitarray_t assigned=((bitarray_t)1<<(i+1))-1;  // the vertices whose images have been chosen
+    bitarray_t used=((bitarray_t)1<<i)-1;  // the images that have been chosen
+    for (int v=i-1; v>=0; v--)
+        perm[v]=v;
+    perm[i]=w;
+    used|=(bitarray_t)1<<w;
+
+    // We assign the free vertices in order of the number of their neighbors that are already assigned,
+    // so that adjacency rules out bad choices as early as possible.
+    search_order.clear();
+    bitarray_t placed=assigned;
+    for (int k=n-1-i; k>0; k--)
+    {
+        int best=-1, best_count=-1;
+        for (int v=i+1; v<n; v++)
+            if ((placed & ((bitarray_t)1<<v))==0)
+            {
+                int c=popcount(neighbors[v] & placed);
+                if (c>best_count)
+                {
+                    best=v;
+                    best_count=c;
+                }
+            }
+        search_order.push_back(best);
+        placed|=(bitarray_t)1<<best;
+    }
+
+    if (!extend(0,assigned,used))
+        return false;
+
+    // The adjacencies among the vertices 0..i are checked by extend only for pairs involving a free vertex.
+    for (int v=i; v>=0; v--)
+        if (image(perm,neighbors[v])!=neighbors[perm[v]])
+            return false;
+    return true;
+}
+
+
+template <typename bitarray_t>
+bool AutomorphismGroup<bitarray_t>::extend(size_t k,bitarray_t assigned,bitarray_t used)
+    // Chooses the image of search_order[k] and later vertices, by backtracking.
+{
+    if (k==search_order.size())
+        return true;
+
+    int v=search_order[k];
+    bitarray_t required=image(perm,neighbors[v] & assigned);  // the images of the assigned neighbors of v
+    for (int u=n-1; u>=0; u--)
+    {
+        bitarray_t u_mask=(bitarray_t)1<<u;
+        if ( ((used & u_mask)==0) &&
+             (f[u]==f[v]) &&
+             ((neighbors[u] & used)==required) &&
+             (popcount(neighbors[u])==popcount(neighbors[v])) )
+        {
+            perm[v]=u;
+            if (extend(k+1,assigned|((bitarray_t)1<<v),used|u_mask))
+                return true;
+        }
+    }
+    return false;
+}
+
+
+template <typename bitarray_t>
+////////////////////////////////////////////////////////////////////////////////////////
+class OrbitPruner
+////////////////////////////////////////////////////////////////////////////////////////
+    // Records the orbits of the colorability classes that have been generated on level 0 of the stack.
+    // This is shared by all of the threads, since the continuation of level 0 moves between them.
+{
+public:
+    const AutomorphismGroup<bitarray_t> &group;
+    std::unordered_set<bitarray_t,BitArrayHash<bitarray_t> > seen;  // the images of the classes generated so far that can be on level 0
+    std::mutex lock;  // protects seen and the counts
+    unsigned long long int num_searched, num_skipped;
+
+    OrbitPruner(const AutomorphismGroup<bitarray_t> &group);
+
+    bool first_in_orbit(const bitarray_t &C);
+};
+
+
+template <typename bitarray_t>
+OrbitPruner<bitarray_t>::OrbitPruner(const AutomorphismGroup<bitarray_t> &group)
+  : // initializer list
+    group(group),
+    num_searched(0),
+    num_skipped(0)
+{
+}
+
+
+template <typename bitarray_t>
+bool OrbitPruner<bitarray_t>::first_in_orbit(const bitarray_t &C)
+    // Returns true if no image of C has been generated before on level 0, and then records the orbit of C.
+{
+    std::lock_guard<std::mutex> guard(lock);
+
+    if (seen.count(C)>0)
+    {
+        num_skipped++;
+        return false;
+    }
+    num_searched++;
+    if (group.generators.empty())
+        return true;
+
+    // We find the orbit of C by a breadth first search.
+    // Only the images containing the highest vertex of C can appear on level 0, so we only keep those in seen.
+    bitarray_t top=(bitarray_t)1<<highest_bit(C);
+    std::unordered_set<bitarray_t,BitArrayHash<bitarray_t> > orbit;
+    std::vector<bitarray_t> queue(1,C);
+    orbit.insert(C);
+    for (size_t q=0; q<queue.size(); q++)
+    {
+        if (queue[q] & top)
+            seen.insert(queue[q]);
+        for (size_t g=0; g<group.generators.size(); g++)
+        {
+            bitarray_t S=group.image(group.generators[g],queue[q]);
+            if (orbit.insert(S).second)
+                queue.push_back(S);
+        }
+    }
+
+    return true;
+}
+
+
+#endif  // AUTOMORPHISM_H__EIGHOOQUAELAHNGAIPHE
@@ -13,6 +13,7 @@
 
 #include <cstdint>
 #include <cstdio>
+#include <vector>
 
 typedef uint_fast64_t bitarray;
 
@@ -20,9 +21,288 @@ typedef uint_fast64_t bitarray;
 // that is as fast as any other integer type with at least this width.
 // Note that std::bitset provides an array of bits in the C++ Standard 
 // Library, so we avoid that name.
-// We use a typedef so that we can easily change to larger widths if 
-// necessary.  gcc and Clang provide 128-bit integers that are emulated
-// from two 64-bit integers.
+// The subgraph generators and the list assignment search are templates on
+// the bitarray type, so that the narrowest type that holds the graph can be
+// used.  Besides the unsigned integer types, gcc and Clang provide 128-bit
+// integers that are emulated from two 64-bit integers, and
+// MultiWordBitArray below handles any multiple of 64 bits.
+
+typedef unsigned __int128 bitarray128;
+
+
+/////////////////////////////////////////////////////////////////////////////
+// A bitarray made of W 64-bit words.
+// The operators behave as they do for unsigned integers of width 64*W,
+// including wrapping around on decrement, so that the same code works for both.
+/////////////////////////////////////////////////////////////////////////////
+
+template <int W>
+class MultiWordBitArray
+{
+public:
+    uint64_t word[W];  // word[0] holds the low order bits
+    
+    MultiWordBitArray(unsigned long long int x=0)
+    {
+        word[0]=x;
+        for (int i=1; i<W; i++)
+            word[i]=0;
+    }
+    
+    explicit operator bool() const
+    {
+        for (int i=0; i<W; i++)
+            if (word[i])
+                return true;
+        return false;
+    }
+    
+    friend bool operator==(const MultiWordBitArray &x, const MultiWordBitArray &y)
+    {
+        for (int i=0; i<W; i++)
+            if (x.word[i]!=y.word[i])
+                return false;
+        return true;
+    }
+    friend bool operator!=(const MultiWordBitArray &x, const MultiWordBitArray &y) { return !(x==y); }
+    
+    MultiWordBitArray& operator&=(const MultiWordBitArray &y) { for (int i=0; i<W; i++) word[i]&=y.word[i]; return *this; }
+    MultiWordBitArray& operator|=(const MultiWordBitArray &y) { for (int i=0; i<W; i++) word[i]|=y.word[i]; return *this; }
+    MultiWordBitArray& operator^=(const MultiWordBitArray &y) { for (int i=0; i<W; i++) word[i]^=y.word[i]; return *this; }
+    friend MultiWordBitArray operator&(MultiWordBitArray x, const MultiWordBitArray &y) { return x&=y; }
+    friend MultiWordBitArray operator|(MultiWordBitArray x, const MultiWordBitArray &y) { return x|=y; }
+    friend MultiWordBitArray operator^(MultiWordBitArray x, const MultiWordBitArray &y) { return x^=y; }
+    
+    MultiWordBitArray operator~() const
+    {
+        MultiWordBitArray x;
+        for (int i=0; i<W; i++)
+            x.word[i]=~word[i];
+        return x;
+    }
+    
+    MultiWordBitArray& operator<<=(int s)
+        // Shifts of 64*W or more bits give 0, unlike for the built in types.
+    {
+        int q=s>>6, r=s&63;
+        for (int i=W-1; i>=0; i--)
+        {
+            uint64_t x=0;
+            if (i-q>=0)
+            {
+                x=word[i-q]<<r;
+                if ((r!=0) && (i-q-1>=0))
+                    x|=word[i-q-1]>>(64-r);
+            }
+            word[i]=x;
+        }
+        return *this;
+    }
+    MultiWordBitArray& operator>>=(int s)
+    {
+        int q=s>>6, r=s&63;
+        for (int i=0; i<W; i++)
+        {
+            uint64_t x=0;
+            if (i+q<W)
+            {
+                x=word[i+q]>>r;
+                if ((r!=0) && (i+q+1<W))
+                    x|=word[i+q+1]<<(64-r);
+            }
+            word[i]=x;
+        }
+        return *this;
+    }
+    friend MultiWordBitArray operator<<(MultiWordBitArray x, int s) { return x<<=s; }
+    friend MultiWordBitArray operator>>(MultiWordBitArray x, int s) { return x>>=s; }
+    
+    MultiWordBitArray& operator+=(const MultiWordBitArray &y)
+    {
+        uint64_t carry=0;
+        for (int i=0; i<W; i++)
+        {
+            uint64_t sum=word[i]+y.word[i];
+            uint64_t new_carry=(sum<word[i]);
+            word[i]=sum+carry;
+            carry=new_carry | (word[i]<sum);
+        }
+        return *this;
+    }
+    MultiWordBitArray& operator-=(const MultiWordBitArray &y)
+    {
+        uint64_t borrow=0;
+        for (int i=0; i<W; i++)
+        {
+            uint64_t diff=word[i]-y.word[i];
+            uint64_t new_borrow=(diff>word[i]);
+            word[i]=diff-borrow;
+            borrow=new_borrow | (word[i]>diff);
+        }
+        return *this;
+    }
+    friend MultiWordBitArray operator+(MultiWordBitArray x, const MultiWordBitArray &y) { return x+=y; }
+    friend MultiWordBitArray operator-(MultiWordBitArray x, const MultiWordBitArray &y) { return x-=y; }
+    MultiWordBitArray operator-() const { return MultiWordBitArray()-*this; }
+    
+    friend bool operator<(const MultiWordBitArray &x, const MultiWordBitArray &y)
+    {
+        for (int i=W-1; i>=0; i--)
+            if (x.word[i]!=y.word[i])
+                return x.word[i]<y.word[i];
+        return false;
+    }
+    MultiWordBitArray& operator--() { return *this-=1; }
+    MultiWordBitArray operator--(int) { MultiWordBitArray x=*this; *this-=1; return x; }
+};
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+// Functions that are specialized for each width.
+/////////////////////////////////////////////////////////////////////////////
+
+
+template <typename bitarray_t>
+inline
+int max_vertices()
+    // The largest number of vertices that can be handled with this bitarray type.
+    // One bit is left over, since the subgraph generators use bit n as a sentinel.
+{
+    return 8*sizeof(bitarray_t)-1;
+}
+
+
+template <typename bitarray_t>
+inline
+bitarray_t bitarray_from_words(const uint64_t *words, int num_words)
+    // Converts num_words 64-bit words, low order word first, such as a row of UndirectedGraph, into a bitarray.
+    // The bitarray must be wide enough to hold the words, so only the wider types are ever shifted.
+{
+    bitarray_t x=0;
+    for (int w=0; w<num_words; w++)
+        x|=bitarray_t(words[w])<<(64*w);
+    return x;
+}
+
+
+// popcount(x) counts the number of bits set.
+inline int popcount(unsigned int x) { return __builtin_popcount(x); }
+inline int popcount(unsigned long int x) { return __builtin_popcountl(x); }
+inline int popcount(unsigned long long int x) { return __builtin_popcountll(x); }
+inline int popcount(bitarray128 x) { return __builtin_popcountll((uint64_t)x)+__builtin_popcountll((uint64_t)(x>>64)); }
+
+template <int W>
+inline
+int popcount(const MultiWordBitArray<W> &x)
+{
+    int count=0;
+    for (int i=0; i<W; i++)
+        count+=__builtin_popcountll(x.word[i]);
+    return count;
+}
+
+
+// lowest_bit(x) and highest_bit(x) are the indices of the lowest and highest bits set.
+// x must not be 0.  Iterating over the bits of x is done with:
+//     for ( ; x!=0; x&=x-1) { int v=lowest_bit(x); ... }
+inline int lowest_bit(unsigned int x) { return __builtin_ctz(x); }
+inline int lowest_bit(unsigned long int x) { return __builtin_ctzl(x); }
+inline int lowest_bit(unsigned long long int x) { return __builtin_ctzll(x); }
+inline int lowest_bit(bitarray128 x) { return ((uint64_t)x) ? __builtin_ctzll((uint64_t)x) : 64+__builtin_ctzll((uint64_t)(x>>64)); }
+
+inline int highest_bit(unsigned int x) { return 31-__builtin_clz(x); }
+inline int highest_bit(unsigned long int x) { return 8*sizeof(x)-1-__builtin_clzl(x); }
+inline int highest_bit(unsigned long long int x) { return 63-__builtin_clzll(x); }
+inline int highest_bit(bitarray128 x) { return (x>>64) ? 127-__builtin_clzll((uint64_t)(x>>64)) : 63-__builtin_clzll((uint64_t)x); }
+
+// get_byte(x,b) returns bits 8*b through 8*b+7 of x.
+template <typename bitarray_t>
+inline
+unsigned int get_byte(const bitarray_t &x, int b)
+{
+    return (unsigned int)((x>>(8*b)) & 255);
+}
+
+template <int W>
+inline
+unsigned int get_byte(const MultiWordBitArray<W> &x, int b)
+{
+    return (x.word[b>>3]>>(8*(b&7))) & 255;
+}
+
+template <int W>
+inline
+int lowest_bit(const MultiWordBitArray<W> &x)
+{
+    int i=0;
+    while (x.word[i]==0)
+        i++;
+    return 64*i+__builtin_ctzll(x.word[i]);
+}
+
+template <int W>
+inline
+int highest_bit(const MultiWordBitArray<W> &x)
+{
+    int i=W-1;
+    while (x.word[i]==0)
+        i--;
+    return 64*i+63-__builtin_clzll(x.word[i]);
+}
+
+
+
+// hash_bits(x) mixes the bits of x into a 64-bit hash value.
+// This is the finalizer of splitmix64.
+inline
+uint64_t hash_bits(unsigned long long int x)
+{
+    x^=x>>30;
+    x*=0xbf58476d1ce4e5b9ULL;
+    x^=x>>27;
+    x*=0x94d049bb133111ebULL;
+    x^=x>>31;
+    return x;
+}
+inline uint64_t hash_bits(unsigned int x) { return hash_bits((unsigned long long int)x); }
+inline uint64_t hash_bits(unsigned long int x) { return hash_bits((unsigned long long int)x); }
+inline uint64_t hash_bits(bitarray128 x) { return hash_bits((unsigned long long int)x ^ hash_bits((unsigned long long int)(x>>64))); }
+
+template <int W>
+inline
+uint64_t hash_bits(const MultiWordBitArray<W> &x)
+{
+    uint64_t h=0;
+    for (int i=W-1; i>=0; i--)
+        h=hash_bits(h^x.word[i]);
+    return h;
+}
+
+
+template <typename bitarray_t>
+struct BitArrayHash
+    // Hashes a bitarray, for use as the key of a hash table.
+{
+    size_t operator()(const bitarray_t &key) const
+    {
+        return hash_bits(key);
+    }
+};
+
+
+template <typename bitarray_t>
+struct BitArrayVectorHash
+    // Hashes a sequence of bitarrays, for use as the key of a hash table.
+{
+    size_t operator()(const std::vector<bitarray_t> &key) const
+    {
+        uint64_t h=key.size();
+        for (size_t i=0; i<key.size(); i++)
+            h=hash_bits(h^hash_bits(key[i]));
+        return h;
+    }
+};
 
 
 
@@ -33,8 +313,9 @@ typedef uint_fast64_t bitarray;
 /////////////////////////////////////////////////////////////////////////////
 
 
+template <typename bitarray_t>
 inline
-bool first_subset(bitarray &x, const bitarray &universe)
+bool first_subset(bitarray_t &x, const bitarray_t &universe)
     // Sets up the first subset, which is the universe itself.
     // Returns true, unless universe itself is empty.
 {
@@ -43,16 +324,18 @@ bool first_subset(bitarray &x, const bitarray &universe)
 }
 
 
+template <typename bitarray_t>
 inline
-void predecessor_of_first_subset(bitarray &x, const bitarray &universe)
+void predecessor_of_first_subset(bitarray_t &x, const bitarray_t &universe)
     // Constructs the predecessor of the first subset, so that when next is called, the first subset is obtained.
 {
     x=universe+1;
 }
 
 
+template <typename bitarray_t>
 inline
-bool next_subset(bitarray &x, const bitarray &universe)
+bool next_subset(bitarray_t &x, const bitarray_t &universe)
 {
     // Returns the next subset of the universe, counting down in lex order.
     // Returns false if there are no more subsets remaining, otherwise true.
@@ -62,7 +345,7 @@ bool next_subset(bitarray &x, const bitarray &universe)
     // http://lhearen.top/2016/07/06/Bit-manipulation/ section 3 on Sets
     // It's also in the fxtbook (Section 1.25 Generating bit subsets of a given word), as well as Knuth's The Art of Computing Volume 4A: Combinatorial Algorithms, Section 7.1.3 subsection Working with fragmented fields.
     
-    bitarray y;
+    bitarray_t y;
     
     // Note that if x==0 (the empty set) initially, then false is returned, but x is also reset to the universe (since -1 is the all 1s vector).  We do this to avoid having a branch in this code.
     
@@ -89,12 +372,9 @@ bool next_subset(bitarray &x, const bitarray &universe)
     // The following operations fill in 1s in all lower-order bit positions after the highest-order bit.
     // The code is inspired by:
     // http://graphics.stanford.edu/~seander/bithacks.html#RoundUpPowerOf2
-    y|=(y>>1);
-    y|=(y>>2);
-    y|=(y>>4);
-    y|=(y>>8);
-    y|=(y>>16);
-    y|=(y>>32);
+    // The loop has a constant number of iterations, so the compiler unrolls it.
+    for (unsigned int shift=1; shift<8*sizeof(bitarray_t); shift<<=1)
+        y|=(y>>shift);
     
     // We now set those bits in x and then & with the universe.
     // Note that the highest-order bit in y will be erased from x by &ed with universe.
@@ -105,19 +385,42 @@ bool next_subset(bitarray &x, const bitarray &universe)
 
 
 
+template <int W>
+inline
+bool next_subset(MultiWordBitArray<W> &x, const MultiWordBitArray<W> &universe)
+{
+    // The same as next_subset above, but filling in the bits below the highest bit of y is done directly,
+    // since shifting a MultiWordBitArray is expensive.
+    
+    bool return_value=((x!=0) & (universe!=0));
+    
+    x--;
+    
+    MultiWordBitArray<W> y=x&(~universe);
+    if (y!=0)
+        y=(((MultiWordBitArray<W>)1<<highest_bit(y))<<1)-1;  // the shift gives 0 if the highest bit is the top bit
+    
+    x=(x|y) & universe;
+    
+    return return_value;
+}
+
+
+
 /////////////////////////////////////////////////////////////////////////////
 // Functions for outputting a bitarray.
 /////////////////////////////////////////////////////////////////////////////
 
 
-void print_binary(bitarray x, int num_bits)
+template <typename bitarray_t>
+void print_binary(bitarray_t x, int num_bits, FILE *file=stdout)
 {
     for (int i=0; i<num_bits; i++)
     {
-        printf("%1d",(int)(x&1));  // print the low bit first
+        fprintf(file,"%1d",(int)((x&1)!=0));  // print the low bit first
         
         if ((i&3)==3)  // print a separator every 4 bits
-            printf("_");
+            fprintf(file,"_");
         
         x>>=1;
     }
@@ -0,0 +1,225 @@
+
+// boundedcache.h
+// This is a C++ library for a hash table of bounded size that evicts entries when full.
+// The library is contained in one header file to enable use of inline functions.
+
+// Copyright 2017, Stephen G. Hartke
+// Licensed under the GPL version 3.
+
+
+#pragma once  // for compilers that support this
+#ifndef BOUNDEDCACHE_H__OHGHAEPHEETHOHQUAIRU  // include guard
+#define BOUNDEDCACHE_H__OHGHAEPHEETHOHQUAIRU
+
+
+#include <vector>
+#include <unordered_map>
+#include <string>
+
+
+/* The cache is limited both in the number of entries and (optionally) in the number of bytes used.
+ * When inserting into a full cache, an entry is evicted using the clock algorithm, which approximates LRU:
+ * each entry has a referenced flag that is set on each lookup, and the clock hand sweeps over the entries,
+ * clearing the flags, until it finds an entry that has not been referenced since the last sweep.
+ * The byte count is an estimate, since the hash table's own memory use is not visible.
+ */
+
+
+template <typename T>
+inline
+size_t key_bytes(const T &key)
+    // The memory used by a key, beyond sizeof(key).
+{
+    return 0;
+}
+
+template <typename T>
+inline
+size_t key_bytes(const std::vector<T> &key)
+{
+    return key.size()*sizeof(T);  // not the capacity, since the copy stored in the table may have a different capacity than the key passed to insert
+}
+
+inline
+size_t key_bytes(const std::string &key)
+{
+    return key.size();
+}
+
+
+template <typename Key, typename Value, typename Hash>
+class BoundedCache
+{
+public:
+    struct Entry
+    {
+        Value value;
+        bool referenced;  // set on lookup, cleared by the clock hand
+    };
+    typedef std::unordered_map<Key,Entry,Hash> Table;
+
+    Table table;
+    std::vector<typename Table::value_type*> clock;  // the entries in the order that the clock hand visits them; pointers stay valid on rehashing, unlike iterators
+    size_t hand;  // the next entry in clock to consider for eviction
+
+    size_t max_entries;  // 0 disables the cache
+    size_t max_bytes;  // 0 means no limit on the bytes used
+    size_t bytes;  // estimated bytes used by the entries
+
+    unsigned long long int hits, misses, evictions;
+
+    BoundedCache(size_t max_entries=0, size_t max_bytes=0);
+
+    bool enabled() const;
+    size_t size() const;
+    bool lookup(const Key &key, Value &value);
+    void insert(const Key &key, const Value &value);
+    void clear();
+
+private:
+    size_t entry_bytes(const Key &key) const;
+    void evict();
+};
+
+
+template <typename Key, typename Value, typename Hash>
+BoundedCache<Key,Value,Hash>::BoundedCache(size_t max_entries, size_t max_bytes)
+  : // initializer list
+    hand(0),
+    max_entries(max_entries),
+    max_bytes(max_bytes),
+    bytes(0),
+    hits(0),
+    misses(0),
+    evictions(0)
+{
+}
+
+
+template <typename Key, typename Value, typename Hash>
+inline
+bool BoundedCache<Key,Value,Hash>::enabled() const
+{
+    return max_entries>0;
+}
+
+
+template <typename Key, typename Value, typename Hash>
+inline
+size_t BoundedCache<Key,Value,Hash>::size() const
+{
+    return clock.size();
+}
+
+
+template <typename Key, typename Value, typename Hash>
+inline
+size_t BoundedCache<Key,Value,Hash>::entry_bytes(const Key &key) const
+{
+    // the key and entry are stored in a node of the hash table along with a next pointer and the hash, and there is a bucket pointer and an iterator in clock
+    return sizeof(Key)+key_bytes(key)+sizeof(Entry)+4*sizeof(void*);
+}
+
+
+template <typename Key, typename Value, typename Hash>
+inline
+bool BoundedCache<Key,Value,Hash>::lookup(const Key &key, Value &value)
+    // Returns true if key is in the cache, and then sets value.
+{
+    typename Table::iterator it=table.find(key);
+    if (it==table.end())
+    {
+        misses++;
+        return false;
+    }
+    hits++;
+    it->second.referenced=true;
+    value=it->second.value;
+    return true;
+}
+
+
+template <typename Key, typename Value, typename Hash>
+void BoundedCache<Key,Value,Hash>::evict()
+    // Removes an entry chosen by the clock algorithm, leaving a hole at clock[hand] to be filled by the caller.
+{
+    while (clock[hand]->second.referenced)
+    {
+        clock[hand]->second.referenced=false;
+        hand++;
+        if (hand>=clock.size())
+            hand=0;
+    }
+    bytes-=entry_bytes(clock[hand]->first);
+    table.erase(table.find(clock[hand]->first));
+    evictions++;
+}
+
+
+template <typename Key, typename Value, typename Hash>
+void BoundedCache<Key,Value,Hash>::insert(const Key &key, const Value &value)
+{
+    if (!enabled())
+        return;
+
+    typename Table::iterator it=table.find(key);
+    if (it!=table.end())
+    {
+        it->second.value=value;
+        return;
+    }
+
+    size_t new_bytes=entry_bytes(key);
+    if ((max_bytes>0) && (new_bytes>max_bytes))
+        return;  // this entry can never fit
+
+    // We evict entries until the new one fits.  The last eviction leaves its slot in clock for the new entry.
+    bool reuse_slot=false;
+    while ( (clock.size()-reuse_slot>=max_entries) ||
+            ((max_bytes>0) && (bytes+new_bytes>max_bytes)) )
+    {
+        if (reuse_slot)
+        {
+            // the previous eviction left a hole; we fill it with the last entry so that we can evict again
+            clock[hand]=clock.back();
+            clock.pop_back();
+            if (hand>=clock.size())
+                hand=0;
+        }
+        evict();
+        reuse_slot=true;
+    }
+
+    Entry entry;
+    entry.value=value;
+    entry.referenced=false;
+    it=table.insert(std::make_pair(key,entry)).first;
+    bytes+=new_bytes;
+
+    if (reuse_slot)
+    {
+        clock[hand]=&*it;
+        hand++;
+        if (hand>=clock.size())
+            hand=0;
+    }
+    else
+        clock.push_back(&*it);
+}
+
+
+template <typename Key, typename Value, typename Hash>
+void BoundedCache<Key,Value,Hash>::clear()
+    // Removes all of the entries and resets the counts, so that the cache can be reused for another graph.
+{
+    table.clear();
+    clock.clear();
+    hand=0;
+    bytes=0;
+    hits=0;
+    misses=0;
+    evictions=0;
+}
+
+
+#endif  // BOUNDEDCACHE_H__OHGHAEPHEETHOHQUAIRU
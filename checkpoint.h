@@ -0,0 +1,361 @@
+
+// checkpoint.h
+// This is a C++ library for saving the state of the search for a bad list assignment to a file, and resuming from it.
+// The library is contained in one header file to enable use of inline functions.
+
+// Copyright 2017, Stephen G. Hartke
+// Licensed under the GPL version 3.
+
+
+#pragma once  // for compilers that support this
+#ifndef CHECKPOINT_H__QUEIPHOHVEEDOOBOHJAE  // include guard
+#define CHECKPOINT_H__QUEIPHOHVEEDOOBOHJAE
+
+
+#include <vector>
+#include <string>
+#include <cstdio>  // for FILE, fprintf, fscanf
+#include <cstring>  // for strlen, strcmp
+#include <ctime>  // for time
+#include <csignal>  // for signal
+#include "bitarray.h"
+#include "taskpool.h"
+#include "periodic.h"
+
+
+/* The search from a given state of the stack is the same as searching the continuation of each level,
+ * from the top level down, which is how the threads split the search (see taskpool.h).
+ * Thus a checkpoint is the list of SearchTasks for the levels of the stack, together with the counts and the odometer,
+ * and the search is resumed by loading and searching the tasks in order from the top level down.
+ * The feasibility cache and the transposition table are not saved, since they only speed up the search.
+ *
+ * A checkpoint is written periodically, when SIGUSR1 is received, and when SIGTERM is received, after which the program stops.
+ * The file is a text file, and it is replaced by renaming a temporary file (see periodic.h).
+ */
+
+
+volatile sig_atomic_t checkpoint_signal=0;  // the last signal received asking for a checkpoint, or 0
+
+
+void checkpoint_signal_handler(int sig)
+{
+    checkpoint_signal=sig;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+class Checkpointer
+////////////////////////////////////////////////////////////////////////////////////////
+    // Decides when a checkpoint is due, and holds what identifies the search besides its state.
+{
+public:
+    std::string filename;
+    int interval;  // the number of seconds between periodic checkpoints
+    time_t next_time;  // when the next periodic checkpoint is due
+
+    std::string graph;  // the fgraph6 string of the graph being searched
+    int res,mod,splitlevel;
+
+    Checkpointer(const std::string &filename,int interval);
+
+    void start(const std::string &graph,int res,int mod,int splitlevel);
+    bool due(unsigned long long int count);
+    bool stop_requested() const;
+    void written();
+};
+
+
+Checkpointer::Checkpointer(const std::string &filename,int interval)
+  : // initializer list
+    filename(filename),
+    interval(interval),
+    next_time(0),
+    res(-1),
+    mod(-1),
+    splitlevel(-1)
+{
+    signal(SIGUSR1,checkpoint_signal_handler);
+    signal(SIGTERM,checkpoint_signal_handler);
+}
+
+
+void Checkpointer::start(const std::string &graph,int res,int mod,int splitlevel)
+    // Called when starting the search of a graph.
+{
+    this->graph=graph;
+    this->res=res;
+    this->mod=mod;
+    this->splitlevel=splitlevel;
+    next_time=time(NULL)+interval;
+}
+
+
+inline
+bool Checkpointer::due(unsigned long long int count)
+{
+    if (checkpoint_signal!=0)
+        return true;
+    return periodic_check_due(count,next_time);
+}
+
+
+inline
+bool Checkpointer::stop_requested() const
+{
+    return checkpoint_signal==SIGTERM;
+}
+
+
+void Checkpointer::written()
+{
+    checkpoint_signal=0;
+    next_time=time(NULL)+interval;
+}
+
+
+template <typename bitarray_t>
+////////////////////////////////////////////////////////////////////////////////////////
+struct CheckpointState
+////////////////////////////////////////////////////////////////////////////////////////
+    // The state of the search, besides the graph and parameters held by Checkpointer.
+{
+    unsigned long long int count, num_feasible_colorings;
+    int odometer;
+    std::vector<SearchTask<bitarray_t>*> tasks;  // ordered by level, from the bottom of the stack up
+
+    // The orbits of the classes on level 0, when automorphisms are used.
+    bool has_orbits;
+    unsigned long long int orbits_searched, orbits_skipped;
+    std::vector<bitarray_t> orbits_seen;
+
+    CheckpointState();
+    ~CheckpointState();
+};
+
+
+template <typename bitarray_t>
+CheckpointState<bitarray_t>::CheckpointState()
+  : // initializer list
+    count(0),
+    num_feasible_colorings(0),
+    odometer(-1),
+    has_orbits(false),
+    orbits_searched(0),
+    orbits_skipped(0)
+{
+}
+
+
+template <typename bitarray_t>
+CheckpointState<bitarray_t>::~CheckpointState()
+{
+    for (size_t i=0; i<tasks.size(); i++)
+        delete tasks[i];
+}
+
+
+/////////////////////////////////////////////////////////////////////////////
+// Reading and writing.
+// Bitarrays are written in hexadecimal with two digits per byte, so that the format does not depend on the width of bitarray_t.
+/////////////////////////////////////////////////////////////////////////////
+
+
+inline
+bool read_word(FILE *file,const char *word)
+    // Reads the next word of the file, and returns true if it is word.
+{
+    char buffer[64];
+    return (fscanf(file,"%63s",buffer)==1) && (strcmp(buffer,word)==0);
+}
+
+
+template <typename bitarray_t>
+void write_bitarray(FILE *file,const bitarray_t &x,int n)
+{
+    fprintf(file," ");
+    for (int b=(n+7)/8-1; b>=0; b--)
+        fprintf(file,"%02x",get_byte(x,b));
+}
+
+
+template <typename bitarray_t>
+bool read_bitarray(FILE *file,bitarray_t &x,int n)
+{
+    char buffer[2*32+1];  // enough for the widest bitarray
+    int num_digits=2*((n+7)/8);
+    if ((num_digits>=(int)sizeof(buffer)) || (fscanf(file,"%64s",buffer)!=1) || ((int)strlen(buffer)!=num_digits))
+        return false;
+
+    x=0;
+    for (int i=0; i<num_digits; i+=2)
+    {
+        unsigned int byte;
+        if (sscanf(buffer+i,"%2x",&byte)!=1)
+            return false;
+        x<<=8;
+        x|=(bitarray_t)byte;
+    }
+    return true;
+}
+
+
+template <typename bitarray_t>
+void write_task(FILE *file,const SearchTask<bitarray_t> &task,int n)
+{
+    fprintf(file,"task %d\n",task.level);
+
+    fprintf(file,"classes");
+    for (int i=0; i<task.level; i++)
+        write_bitarray(file,task.colorability_class[i],n);
+    fprintf(file,"\n");
+
+    fprintf(file,"info");
+    write_bitarray(file,task.info.colorability_class,n);
+    write_bitarray(file,task.info.eligible_vertices,n);
+    write_bitarray(file,task.info.eligible_generators,n);
+    for (int v=0; v<n; v++)
+        fprintf(file," %d",task.info.L[v]);
+    fprintf(file,"\n");
+
+    for (int v=0; v<n; v++)
+    {
+        const ConnectedSubgraph<bitarray_t> &S=task.generator[v];
+        fprintf(file,"generator %d %d",S.root,S.cur_layer);
+        write_bitarray(file,S.eligible_vertices,n);
+        for (int i=0; i<=S.cur_layer; i++)
+        {
+            write_bitarray(file,S.layer[i].layer_universe,n);
+            write_bitarray(file,S.layer[i].layer_subset,n);
+            write_bitarray(file,S.layer[i].union_universe,n);
+            write_bitarray(file,S.layer[i].union_subset,n);
+        }
+        fprintf(file,"\n");
+    }
+}
+
+
+template <typename bitarray_t>
+bool read_task(FILE *file,SearchTask<bitarray_t> &task,int n)
+{
+    if (!read_word(file,"task") || (fscanf(file,"%d",&task.level)!=1) || (task.level<0) ||
+        !read_word(file,"classes"))
+        return false;
+    task.colorability_class.resize(task.level);
+    for (int i=0; i<task.level; i++)
+        if (!read_bitarray(file,task.colorability_class[i],n))
+            return false;
+
+    if ( !read_word(file,"info") ||
+         !read_bitarray(file,task.info.colorability_class,n) ||
+         !read_bitarray(file,task.info.eligible_vertices,n) ||
+         !read_bitarray(file,task.info.eligible_generators,n) )
+        return false;
+    for (int v=0; v<n; v++)
+        if (fscanf(file,"%d",&task.info.L[v])!=1)
+            return false;
+
+    for (int v=0; v<n; v++)
+    {
+        ConnectedSubgraph<bitarray_t> &S=task.generator[v];
+        if ( !read_word(file,"generator") || (fscanf(file,"%d %d",&S.root,&S.cur_layer)!=2) ||
+             (S.root!=v) || (S.cur_layer<-1) || (S.cur_layer>=n) ||  // an exhausted generator can have cur_layer==-1
+             !read_bitarray(file,S.eligible_vertices,n) )
+            return false;
+        for (int i=0; i<=S.cur_layer; i++)
+            if ( !read_bitarray(file,S.layer[i].layer_universe,n) ||
+                 !read_bitarray(file,S.layer[i].layer_subset,n) ||
+                 !read_bitarray(file,S.layer[i].union_universe,n) ||
+                 !read_bitarray(file,S.layer[i].union_subset,n) )
+                return false;
+    }
+    return true;
+}
+
+
+template <typename bitarray_t>
+bool write_checkpoint(const Checkpointer &checkpointer,const CheckpointState<bitarray_t> &state,int n)
+    // Returns false if the file could not be written.
+{
+    FILE *file=open_temporary_file(checkpointer.filename);
+    if (file==NULL)
+        return false;
+
+    fprintf(file,"fchoosability_exhaustive checkpoint 1\n");
+    fprintf(file,"graph %s\n",checkpointer.graph.c_str());
+    fprintf(file,"parameters %d %d %d\n",checkpointer.res,checkpointer.mod,checkpointer.splitlevel);
+    fprintf(file,"counts %llu %llu %d\n",state.count,state.num_feasible_colorings,state.odometer);
+
+    fprintf(file,"orbits %d %llu %llu %lu",state.has_orbits,state.orbits_searched,state.orbits_skipped,state.orbits_seen.size());
+    for (size_t i=0; i<state.orbits_seen.size(); i++)
+        write_bitarray(file,state.orbits_seen[i],n);
+    fprintf(file,"\n");
+
+    fprintf(file,"tasks %lu\n",state.tasks.size());
+    for (size_t i=0; i<state.tasks.size(); i++)
+        write_task(file,*state.tasks[i],n);
+    fprintf(file,"end\n");
+
+    return replace_with_temporary_file(file,checkpointer.filename);
+}
+
+
+bool read_checkpoint_header(const std::string &filename,std::string &graph,int &res,int &mod,int &splitlevel)
+    // Reads the graph and parameters of a checkpoint, so that the graph can be found in the input.
+{
+    FILE *file=fopen(filename.c_str(),"r");
+    if (file==NULL)
+        return false;
+
+    char buffer[4096];
+    int version;
+    bool ok= read_word(file,"fchoosability_exhaustive") && read_word(file,"checkpoint") &&
+             (fscanf(file,"%d",&version)==1) && (version==1) &&
+             read_word(file,"graph") && (fscanf(file,"%4095s",buffer)==1) &&
+             read_word(file,"parameters") && (fscanf(file,"%d %d %d",&res,&mod,&splitlevel)==3);
+    if (ok)
+        graph=buffer;
+    fclose(file);
+    return ok;
+}
+
+
+template <typename bitarray_t>
+bool read_checkpoint(const std::string &filename,CheckpointState<bitarray_t> &state,
+                     int n,const std::vector<bitarray_t> &neighbors,const NeighborhoodTable<bitarray_t> &neighborhood)
+    // Reads the state of the search from a checkpoint; the header has already been checked with read_checkpoint_header.
+{
+    FILE *file=fopen(filename.c_str(),"r");
+    if (file==NULL)
+        return false;
+
+    char buffer[4096];
+    int res,mod,splitlevel,has_orbits;
+    size_t num_seen,num_tasks;
+    bool ok= read_word(file,"fchoosability_exhaustive") && read_word(file,"checkpoint") && read_word(file,"1") &&
+             read_word(file,"graph") && (fscanf(file,"%4095s",buffer)==1) &&
+             read_word(file,"parameters") && (fscanf(file,"%d %d %d",&res,&mod,&splitlevel)==3) &&
+             read_word(file,"counts") && (fscanf(file,"%llu %llu %d",&state.count,&state.num_feasible_colorings,&state.odometer)==3) &&
+             read_word(file,"orbits") && (fscanf(file,"%d %llu %llu %lu",&has_orbits,&state.orbits_searched,&state.orbits_skipped,&num_seen)==4);
+    state.has_orbits=has_orbits;
+
+    if (ok)
+    {
+        state.orbits_seen.resize(num_seen);
+        for (size_t i=0; ok && i<num_seen; i++)
+            ok=read_bitarray(file,state.orbits_seen[i],n);
+    }
+
+    ok=ok && read_word(file,"tasks") && (fscanf(file,"%lu",&num_tasks)==1);
+    for (size_t i=0; ok && i<num_tasks; i++)
+    {
+        state.tasks.push_back(new SearchTask<bitarray_t>(n,neighbors,neighborhood));
+        ok=read_task(file,*state.tasks.back(),n) && (state.tasks.back()->level==(int)i);
+    }
+
+    ok=ok && read_word(file,"end") && (num_tasks>0);
+    fclose(file);
+    return ok;
+}
+
+
+#endif  // CHECKPOINT_H__QUEIPHOHVEEDOOBOHJAE
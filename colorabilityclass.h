@@ -17,6 +17,7 @@
 #include "subgraph.h"
 
 
+template <typename bitarray_t>
 ////////////////////////////////////////////////////////////////////////////////////////
 class ColorabilityClassInfo
 ////////////////////////////////////////////////////////////////////////////////////////
@@ -24,35 +25,47 @@ class ColorabilityClassInfo
 public:
     // we only needs these for the copy and copy assignment constructors
     int n;  // number of vertices in the whole graph
-    const std::vector<bitarray> &neighbors;  // adjacencies in the graph
+    const std::vector<bitarray_t> &neighbors;  // adjacencies in the graph
     
-    bitarray colorability_class;  // the set of vertices assigned this color
+    bitarray_t colorability_class;  // the set of vertices assigned this color
     std::vector<int> L;  // for each vertex, the number of colors already assigned to its list; does not include colorability_class for this color
-    bitarray eligible_vertices;  // set of vertices whose lists are not full (ie, L[v]<f[v]) and so can be included in this color's colorability class
+    bitarray_t eligible_vertices;  // set of vertices whose lists are not full (ie, L[v]<f[v]) and so can be included in this color's colorability class
     
-    std::vector<ConnectedSubgraph> generator;  // pointers to subgraph generators rooted at each vertex
-    bitarray eligible_generators;  // set of vertices whose generators are eligible to generate another subgraph; this is a subset of eligible vertices; eligible vertices not included are those generators that have finished generating subgraphs rooted at that vertex.
+    std::vector<ConnectedSubgraph<bitarray_t> > &generator;  // subgraph generators rooted at each vertex; these are shared by all levels of the stack
+    SubgraphUndoLog<bitarray_t> &undo_log;  // records the changes to the generators, so that each level can restore them
+    size_t undo_mark;  // the size of undo_log when this level was set up
+    unsigned long long int undo_frame;  // the frame of undo_log for this level
+    bitarray_t eligible_generators;  // set of vertices whose generators are eligible to generate another subgraph; this is a subset of eligible vertices; eligible vertices not included are those generators that have finished generating subgraphs rooted at that vertex.
 
-    ColorabilityClassInfo(int n,const std::vector<bitarray> &neighbors);
+    ColorabilityClassInfo(int n,const std::vector<bitarray_t> &neighbors,
+                          std::vector<ConnectedSubgraph<bitarray_t> > &generator,SubgraphUndoLog<bitarray_t> &undo_log);
     ColorabilityClassInfo(const ColorabilityClassInfo &other);
     ColorabilityClassInfo& operator=(const ColorabilityClassInfo &other);  //FIXME: Why do we need this????
     
     bool generate_subgraph();
     void setup_next_from(const ColorabilityClassInfo &prev,const std::vector<int> &f);
+    void copy_from(const ColorabilityClassInfo &other);
+    void restore_generators();
 };
 
 
-ColorabilityClassInfo::ColorabilityClassInfo(int n,const std::vector<bitarray> &neighbors)
+template <typename bitarray_t>
+ColorabilityClassInfo<bitarray_t>::ColorabilityClassInfo(int n,const std::vector<bitarray_t> &neighbors,
+                                             std::vector<ConnectedSubgraph<bitarray_t> > &generator,SubgraphUndoLog<bitarray_t> &undo_log)
   : // intialization list
     n(n),
     neighbors(neighbors),
     L(n,0),  // intialize L to 0
-    generator(n,ConnectedSubgraph(n,neighbors))
+    generator(generator),
+    undo_log(undo_log),
+    undo_mark(0),
+    undo_frame(undo_log.frame)
 {
 }
 
 
-ColorabilityClassInfo::ColorabilityClassInfo(const ColorabilityClassInfo &other)
+template <typename bitarray_t>
+ColorabilityClassInfo<bitarray_t>::ColorabilityClassInfo(const ColorabilityClassInfo &other)
     // copy constructor, used in initialization of vectors of these objects
   : // intialization list
     n(other.n),
@@ -60,14 +73,18 @@ ColorabilityClassInfo::ColorabilityClassInfo(const ColorabilityClassInfo &other)
     colorability_class(other.colorability_class),
     L(other.n,0),
     eligible_vertices(other.eligible_vertices),
-    generator(other.n,ConnectedSubgraph(other.n,other.neighbors)),
+    generator(other.generator),
+    undo_log(other.undo_log),
+    undo_mark(other.undo_mark),
+    undo_frame(other.undo_frame),
     eligible_generators(other.eligible_generators)
 {
     //printf("ColorabilityClassInfo copy constructor\n");
 }
 
 
-ColorabilityClassInfo& ColorabilityClassInfo::operator=(const ColorabilityClassInfo &other)
+template <typename bitarray_t>
+ColorabilityClassInfo<bitarray_t>& ColorabilityClassInfo<bitarray_t>::operator=(const ColorabilityClassInfo &other)
     // copy assignment constructor, used in initialization of vectors of these objects
 
 {
@@ -78,7 +95,8 @@ ColorabilityClassInfo& ColorabilityClassInfo::operator=(const ColorabilityClassI
 }
 
 
-bool ColorabilityClassInfo::generate_subgraph()
+template <typename bitarray_t>
+bool ColorabilityClassInfo<bitarray_t>::generate_subgraph()
     // Generates another connected subgraph to use as the next colorability class.
     // This subgraph is stored in the member colorability_class.
     // Returns false if there are no more subgraphs to generate.
@@ -90,7 +108,7 @@ bool ColorabilityClassInfo::generate_subgraph()
         
         int min_L=n;
         int min_v=0;
-        bitarray mask=1<<(n-1);
+        bitarray_t mask=(bitarray_t)1<<(n-1);
         
         //printf("Searching for vertex v to poke its generator\n");
         for (int v=n-1; v>=0; v--)
@@ -110,14 +128,14 @@ bool ColorabilityClassInfo::generate_subgraph()
             {
                 //printf("We found L[%d]==0\n",v);
                 
-                eligible_generators|=1<<n;  // this ensures the following loop terminates
+                eligible_generators|=(bitarray_t)1<<n;  // this ensures the following loop terminates
                 min_v=v;
                 while (!(mask & eligible_generators))
                 {
                     min_v++;
                     mask<<=1;
                 }
-                eligible_generators^=1<<n;  // clear this high bit
+                eligible_generators^=(bitarray_t)1<<n;  // clear this high bit
                 
                 if (mask & eligible_generators)
                     // Note that eligible_generators is a subset of eligible_vertices.
@@ -163,7 +181,7 @@ bool ColorabilityClassInfo::generate_subgraph()
         
         if (min_L<n)  // we found a vertex to poke!
         {
-            if (generator[min_v].next(eligible_vertices))
+            if (generator[min_v].next(eligible_vertices,&undo_log))
             {
                 // we successfully generated a new subgraph!
                 //printf("We successfully generated a new subgraph!\n");
@@ -181,7 +199,7 @@ bool ColorabilityClassInfo::generate_subgraph()
             }
             else
             {
-                eligible_generators^=(1<<min_v);  // vertex min_v no longer has an eligible generator, since it has finished generating all its subgraphs
+                eligible_generators^=((bitarray_t)1<<min_v);  // vertex min_v no longer has an eligible generator, since it has finished generating all its subgraphs
                 
                 // We need to check if any vertex v with L[v]==0 now has no way to have a color added to its list.
                 /*
@@ -235,14 +253,15 @@ bool ColorabilityClassInfo::generate_subgraph()
 }
 
 
-void ColorabilityClassInfo::setup_next_from(const ColorabilityClassInfo &prev,
+template <typename bitarray_t>
+void ColorabilityClassInfo<bitarray_t>::setup_next_from(const ColorabilityClassInfo &prev,
                                             const std::vector<int> &f)
 {
     // We assume that prev.colorability_class is a valid connected subgraph that is not represented in the L or eligible_vertices members of prev.
     
     eligible_vertices=prev.eligible_vertices;  // we will modify as necessary
     
-    bitarray mask=1<<(n-1);
+    bitarray_t mask=(bitarray_t)1<<(n-1);
     for (int v=n-1; v>=0; v--)
     {
         // TODO: we could eliminate the if statement by having a conditional add to L[v]; the tricky thing is how to handle eligible vertices; can't be a xor anymore; probably can use an & mask (e_v&=);
@@ -260,8 +279,9 @@ void ColorabilityClassInfo::setup_next_from(const ColorabilityClassInfo &prev,
         mask>>=1;
     }
     
-    for (int i=n-1; i>=0; i--)
-        generator[i].copy_from(prev.generator[i]);
+    // The generators are shared with prev, so we only start a new frame of the undo log instead of copying them.
+    undo_mark=undo_log.size();
+    undo_frame=undo_log.new_frame();
     
     eligible_generators=prev.eligible_generators & eligible_vertices;
         // the eligible generators is a subset of the eligible vertices
@@ -270,4 +290,29 @@ void ColorabilityClassInfo::setup_next_from(const ColorabilityClassInfo &prev,
 }
 
 
+template <typename bitarray_t>
+void ColorabilityClassInfo<bitarray_t>::copy_from(const ColorabilityClassInfo &other)
+{
+    // We assume that n and neighbors are the same for other and this object.
+    // This is used to move a level of the stack between threads.
+    // The generators are not copied, since they are shared by all levels.
+    colorability_class=other.colorability_class;
+    eligible_vertices=other.eligible_vertices;
+    eligible_generators=other.eligible_generators;
+
+    for (int v=n-1; v>=0; v--)
+        L[v]=other.L[v];
+}
+
+
+template <typename bitarray_t>
+inline
+void ColorabilityClassInfo<bitarray_t>::restore_generators()
+{
+    // We undo all changes to the generators made since this level was set up.
+    // This is called when backtracking from this level, so that the previous level finds the generators as it left them.
+    undo_log.undo(generator,undo_mark);
+}
+
+
 #endif  // COLORABILITYCLASS_H__UOMEICEIHALUAFETHAEF
@@ -0,0 +1,369 @@
+
+// coordinator.h
+// This is a C++ library for splitting the search for a bad list assignment into residues that are searched by separate processes.
+// The library is contained in one header file to enable use of inline functions.
+
+// Copyright 2017, Stephen G. Hartke
+// Licensed under the GPL version 3.
+
+
+#pragma once  // for compilers that support this
+#ifndef COORDINATOR_H__XOHNGAEQUAHPHIEJEIVU  // include guard
+#define COORDINATOR_H__XOHNGAEQUAHPHIEJEIVU
+
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <cstdio>  // for printf and open_memstream
+#include <cstdlib>  // for exit and free
+#include <cstring>  // for strncmp and memchr
+#include <cerrno>
+#include <unistd.h>  // for fork, pipe, read, and write
+#include <poll.h>
+#include <signal.h>  // for kill
+#include <sys/wait.h>  // for waitpid
+#include <sys/resource.h>  // for getrusage
+#include "fgraph.h"
+#include "exhaustive.h"
+
+
+/* With -r/-m, each residue searches the levels of the stack up to splitlevel, and only expands the nodes at splitlevel with its residue.
+ * The coordinator forks a process for each residue, running num_processes at a time, and each process sends back its result
+ * and its counts through a pipe.  The output of a process is only sent if it found a bad list assignment,
+ * and then the coordinator kills the other processes, since the graph is not f-choosable.
+ * The processes do not report the verdict, so that the coordinator reports it once for the whole search.
+ * A process that dies without sending its result is started again, up to max_attempts times in all.
+ *
+ * Every residue searches the same levels up to splitlevel, so the coordinator checks that they all agree on the counts of those levels
+ * and on the number of nodes at splitlevel, and that each of those nodes was expanded by exactly one residue.
+ * Then the residues covered the whole search, and the combined counts are the counts of the search without the split.
+ *
+ * The processes are forked after the graph has been read, so they share it with the coordinator.
+ * Their CPU time is not included in clock(), so it is given by children_cpu_seconds.
+ */
+
+
+struct SplitResult
+    // What a process sends through its pipe, followed by text_length bytes of its output.
+{
+    int res;
+    int fchoosable;  // 1 if no bad list assignment was found
+    SearchTotals totals;
+    size_t text_length;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+class SplitCoordinator
+////////////////////////////////////////////////////////////////////////////////////////
+{
+public:
+    static const int max_attempts=3;
+    
+    const fGraph &G;
+    int mod,splitlevel;
+    int num_processes;
+    const SearchOptions &options;
+    FILE *out;
+    
+    SplitCoordinator(const fGraph &G,int mod,int splitlevel,int num_processes,const SearchOptions &options,FILE *out);
+    
+    bool run();
+
+private:
+    struct Worker
+    {
+        pid_t pid;
+        int fd;  // the read end of the pipe
+        int res;
+        std::string received;
+    };
+    
+    std::deque<int> waiting;  // the residues that have not been started
+    std::vector<int> attempts;  // indexed by residue
+    std::vector<Worker> workers;  // the running processes
+    std::vector<SplitResult> results;  // the residues that have finished
+    
+    void start(int res);
+    void search_residue(int res,int fd);
+    bool finish(Worker &worker);
+    void kill_all();
+    bool combine();
+};
+
+
+SplitCoordinator::SplitCoordinator(const fGraph &G,int mod,int splitlevel,int num_processes,const SearchOptions &options,FILE *out)
+  : // initializer list
+    G(G),
+    mod(mod),
+    splitlevel(splitlevel),
+    num_processes(num_processes),
+    options(options),
+    out(out),
+    attempts(mod,0)
+{
+}
+
+
+void SplitCoordinator::start(int res)
+{
+    int fds[2];
+    if (pipe(fds)!=0)
+    {
+        printf("Could not create a pipe for residue %d.\n",res);
+        exit(11);
+    }
+    
+    fflush(stdout);  // otherwise the process would write the buffered output again
+    fflush(out);
+    pid_t pid=fork();
+    if (pid<0)
+    {
+        printf("Could not fork a process for residue %d.\n",res);
+        exit(11);
+    }
+    if (pid==0)
+    {
+        close(fds[0]);
+        for (size_t w=0; w<workers.size(); w++)
+            close(workers[w].fd);
+        search_residue(res,fds[1]);
+        _exit(0);
+    }
+    
+    close(fds[1]);
+    attempts[res]++;
+    Worker worker;
+    worker.pid=pid;
+    worker.fd=fds[0];
+    worker.res=res;
+    workers.push_back(worker);
+}
+
+
+void SplitCoordinator::search_residue(int res,int fd)
+    // Run by the forked process.
+{
+    char *text=NULL;
+    size_t text_size=0;
+    FILE *text_out=open_memstream(&text,&text_size);
+    if (text_out==NULL)
+        _exit(1);
+    
+    SearchOptions residue_options=options;
+    SplitResult result;
+    residue_options.totals=&result.totals;
+    result.res=res;
+    result.fchoosable=search_exhaustive(G,res,mod,splitlevel,residue_options,text_out);
+    fclose(text_out);
+    
+    // The report of a bad list assignment is sent without the Odometer tick line of each node at splitlevel,
+    // since the coordinator checks the nodes expanded by their counts.
+    std::string report;
+    if (!result.fchoosable)
+        for (size_t start=0; start<text_size; )
+        {
+            const char *newline=(const char*)memchr(text+start,'\n',text_size-start);
+            size_t end=(newline==NULL) ? text_size : newline-text+1;
+            if (strncmp(text+start,"Odometer tick!",14)!=0)
+                report.append(text+start,end-start);
+            start=end;
+        }
+    free(text);
+    result.text_length=report.size();
+    
+    std::string message((const char*)&result,sizeof(result));
+    message+=report;
+    for (size_t written=0; written<message.size(); )
+    {
+        ssize_t num_written=write(fd,message.data()+written,message.size()-written);
+        if (num_written<0)
+        {
+            if (errno==EINTR)
+                continue;
+            _exit(1);
+        }
+        written+=num_written;
+    }
+    close(fd);
+}
+
+
+bool SplitCoordinator::finish(Worker &worker)
+    // Called when the pipe of worker is closed.  Returns false if the residue found a bad list assignment.
+{
+    int status;
+    close(worker.fd);
+    while ((waitpid(worker.pid,&status,0)<0) && (errno==EINTR))
+        ;
+    
+    const SplitResult *result=(const SplitResult*)worker.received.data();
+    if (!WIFEXITED(status) || (WEXITSTATUS(status)!=0) || (worker.received.size()<sizeof(SplitResult)) ||
+        (worker.received.size()!=sizeof(SplitResult)+result->text_length) || (result->res!=worker.res))
+    {
+        fprintf(out,"The process for residue %d failed",worker.res);
+        if (attempts[worker.res]>=max_attempts)
+        {
+            fprintf(out,", for the last of %d attempts.\n",max_attempts);
+            kill_all();
+            exit(11);
+        }
+        fprintf(out,", so it is started again.\n");
+        waiting.push_front(worker.res);
+        return true;
+    }
+    
+    if (!result->fchoosable)
+    {
+        fprintf(out,"Residue %d found a bad list assignment:\n",worker.res);
+        fwrite(worker.received.data()+sizeof(SplitResult),1,result->text_length,out);
+        return false;
+    }
+    
+    results.push_back(*result);
+    return true;
+}
+
+
+void SplitCoordinator::kill_all()
+{
+    for (size_t w=0; w<workers.size(); w++)
+    {
+        kill(workers[w].pid,SIGKILL);
+        close(workers[w].fd);
+        while ((waitpid(workers[w].pid,NULL,0)<0) && (errno==EINTR))
+            ;
+    }
+    workers.clear();
+}
+
+
+bool SplitCoordinator::run()
+    // Returns true if no residue finds a bad list assignment.
+{
+    for (int res=0; res<mod; res++)
+        waiting.push_back(res);
+    
+    while (!waiting.empty() || !workers.empty())
+    {
+        while (!waiting.empty() && ((int)workers.size()<num_processes))
+        {
+            start(waiting.front());
+            waiting.pop_front();
+        }
+        
+        std::vector<struct pollfd> fds(workers.size());
+        for (size_t w=0; w<workers.size(); w++)
+        {
+            fds[w].fd=workers[w].fd;
+            fds[w].events=POLLIN;
+        }
+        if (poll(&fds[0],fds.size(),-1)<0)
+        {
+            if (errno==EINTR)
+                continue;
+            printf("Could not wait for the processes.\n");
+            exit(11);
+        }
+        
+        for (size_t w=workers.size(); w-->0; )  // backwards, so that finished workers can be removed
+        {
+            if (!(fds[w].revents & (POLLIN|POLLHUP|POLLERR)))
+                continue;
+            
+            char buffer[4096];
+            ssize_t num_read=read(workers[w].fd,buffer,sizeof(buffer));
+            if ((num_read<0) && (errno==EINTR))
+                continue;
+            if (num_read>0)
+            {
+                workers[w].received.append(buffer,num_read);
+                continue;
+            }
+            
+            Worker worker=workers[w];  // the pipe is closed, so the process is done
+            workers.erase(workers.begin()+w);
+            if (!finish(worker))
+            {
+                kill_all();  // the graph is not f-choosable, so the other residues are not needed
+                return false;
+            }
+        }
+    }
+    
+    return combine();
+}
+
+
+bool SplitCoordinator::combine()
+    // Checks that the residues covered the whole search, and reports the combined counts.
+{
+    const SearchTotals &first=results[0].totals;
+    SearchTotals combined=first;
+    unsigned long long int num_expanded_nodes=0;
+    bool consistent=true;
+    
+    for (size_t r=0; r<results.size(); r++)
+    {
+        const SearchTotals &totals=results[r].totals;
+        if ((totals.shared_count!=first.shared_count) || (totals.shared_feasible_colorings!=first.shared_feasible_colorings) ||
+            (totals.num_split_nodes!=first.num_split_nodes))
+        {
+            fprintf(out,"Residue %d disagrees with residue %d on the levels up to splitlevel: count=%llu,%llu num_feasible_colorings=%llu,%llu nodes at splitlevel=%llu,%llu\n",
+                    results[r].res,results[0].res,totals.shared_count,first.shared_count,
+                    totals.shared_feasible_colorings,first.shared_feasible_colorings,totals.num_split_nodes,first.num_split_nodes);
+            consistent=false;
+        }
+        num_expanded_nodes+=totals.num_expanded_nodes;
+        if (r>0)
+        {
+            combined.count+=totals.count-totals.shared_count;
+            combined.num_feasible_colorings+=totals.num_feasible_colorings-totals.shared_feasible_colorings;
+        }
+    }
+    if (num_expanded_nodes!=first.num_split_nodes)
+    {
+        fprintf(out,"The residues expanded %llu nodes at splitlevel, but there are %llu.\n",num_expanded_nodes,first.num_split_nodes);
+        consistent=false;
+    }
+    if (!consistent)
+    {
+        fprintf(out,"The split search cannot be verified!\n");
+        exit(11);
+    }
+    
+    fprintf(out,"All %d residues checked, combined count=%llu, num_feasible_colorings=%llu, nodes at splitlevel=%llu\n",
+            mod,combined.count,combined.num_feasible_colorings,first.num_split_nodes);
+    return true;
+}
+
+
+double children_cpu_seconds()
+    // The CPU time used by the processes that have finished and been waited for, such as the processes of the residues.
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_CHILDREN,&usage)!=0)
+        return 0;
+    return usage.ru_utime.tv_sec+usage.ru_utime.tv_usec/1e6+usage.ru_stime.tv_sec+usage.ru_stime.tv_usec/1e6;
+}
+
+
+bool is_fchoosable_split(const fGraph &G,int mod,int splitlevel,int num_processes,const SearchOptions &options,FILE *out)
+    // We test if the fgraph G is f-choosable by searching each residue modulo mod in its own process, and report to out.
+{
+    SplitCoordinator coordinator(G,mod,splitlevel,num_processes,options,out);
+    if (coordinator.run())
+    {
+        fprintf(out,"This graph is f-choosable!\n");
+        return true;
+    }
+    else
+    {
+        fprintf(out,"This graph is NOT f-choosable!\n");
+        return false;
+    }
+}
+
+
+#endif  // COORDINATOR_H__XOHNGAEQUAHPHIEJEIVU
@@ -0,0 +1,166 @@
+
+// estimator.h
+// This is a C++ library for estimating the size of the search for a bad list assignment, and reporting its progress.
+// The library is contained in one header file to enable use of inline functions.
+
+// Copyright 2017, Stephen G. Hartke
+// Licensed under the GPL version 3.
+
+
+#pragma once  // for compilers that support this
+#ifndef ESTIMATOR_H__AEMOHXEIPHUOVAICHEEL  // include guard
+#define ESTIMATOR_H__AEMOHXEIPHUOVAICHEEL
+
+
+#include <cstdio>  // for fprintf
+#include <ctime>  // for time
+#include <cmath>  // for sqrt
+#include <algorithm>  // for max
+#include "periodic.h"
+
+
+/* The size of a backtracking search can be estimated by Knuth's method of random probes:
+ * a probe follows a random path from the root of the search tree, choosing each child with equal probability,
+ * and the number of nodes at each level of the path times the product of the numbers of children above it
+ * is an unbiased estimate of the number of nodes at that level of the tree.  The sum over the path estimates the whole tree.
+ * See ListAssignment::probe for how the path is followed through the colorability class stack.
+ *
+ * The estimates of single probes vary a lot, since a probe that happens to reach a large subtree multiplies it by many choices,
+ * so many probes are averaged.  The mean is reported with its standard error, but not as a confidence interval:
+ * the estimates of a search tree are heavy tailed, and until the probes reach its rare large subtrees,
+ * both the mean and the standard error are usually too small, so the true count is often several standard errors above the mean.
+ */
+
+
+struct SearchEstimate
+    // The mean of the estimates of the probes, and its standard error.
+{
+    int num_probes;
+    double total, total_squares;
+    bool found_bad_list;  // whether a probe reached a bad list assignment, which ends the probes
+    
+    SearchEstimate();
+    
+    void add(double estimate);
+    double mean() const;
+    double standard_error() const;
+};
+
+
+SearchEstimate::SearchEstimate()
+  : // initializer list
+    num_probes(0),
+    total(0),
+    total_squares(0),
+    found_bad_list(false)
+{
+}
+
+
+inline
+void SearchEstimate::add(double estimate)
+{
+    num_probes++;
+    total+=estimate;
+    total_squares+=estimate*estimate;
+}
+
+
+inline
+double SearchEstimate::mean() const
+{
+    return (num_probes>0) ? total/num_probes : 0;
+}
+
+
+inline
+double SearchEstimate::standard_error() const
+{
+    if (num_probes<2)
+        return 0;
+    double variance=(total_squares-total*mean())/(num_probes-1);  // the sample variance
+    return sqrt(std::max(0.0,variance)/num_probes);
+}
+
+
+void format_duration(double seconds,char *buffer,size_t size)
+    // Writes seconds in the largest unit in which it is at least 1.
+{
+    if (seconds<60)
+        snprintf(buffer,size,"%.1f seconds",seconds);
+    else if (seconds<3600)
+        snprintf(buffer,size,"%.1f minutes",seconds/60);
+    else if (seconds<86400)
+        snprintf(buffer,size,"%.1f hours",seconds/3600);
+    else if (seconds<86400*365.25)
+        snprintf(buffer,size,"%.1f days",seconds/86400);
+    else
+        snprintf(buffer,size,"%.3g years",seconds/(86400*365.25));
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+class ProgressReporter
+////////////////////////////////////////////////////////////////////////////////////////
+    // Reports the count of the search, and the time remaining until it reaches the estimated count at the rate measured so far.
+{
+public:
+    double estimated_count;
+    int interval;  // the number of seconds between reports
+    unsigned long long int start_count;  // the count when the search started, which is not 0 when resuming
+    time_t start_time, next_time;
+    FILE *out;
+    
+    ProgressReporter(double estimated_count,int interval,FILE *out);
+    
+    void start(unsigned long long int count);
+    bool due(unsigned long long int count) const;
+    void report(unsigned long long int count);
+};
+
+
+ProgressReporter::ProgressReporter(double estimated_count,int interval,FILE *out)
+  : // initializer list
+    estimated_count(estimated_count),
+    interval(interval),
+    out(out)
+{
+    start(0);
+}
+
+
+void ProgressReporter::start(unsigned long long int count)
+{
+    start_count=count;
+    start_time=time(NULL);
+    next_time=start_time+interval;
+}
+
+
+inline
+bool ProgressReporter::due(unsigned long long int count) const
+{
+    return periodic_check_due(count,next_time);
+}
+
+
+void ProgressReporter::report(unsigned long long int count)
+{
+    time_t now=time(NULL);
+    next_time=now+interval;
+    double rate=(double)(count-start_count)/std::max((time_t)1,now-start_time);
+    
+    fprintf(out,"Progress: count=%llu of an estimated %.4g, %.0f nodes per second, ",count,estimated_count,rate);
+    if ((count<estimated_count) && (rate>0))
+    {
+        char remaining[64];
+        format_duration((estimated_count-count)/rate,remaining,sizeof(remaining));
+        fprintf(out,"%.1f%% done, ETA %s\n",100*count/estimated_count,remaining);
+    }
+    else
+        fprintf(out,"past the estimate, so the time remaining is unknown\n");
+    fflush(out);
+}
+
+
+#endif  // ESTIMATOR_H__AEMOHXEIPHUOVAICHEEL
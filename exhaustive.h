@@ -0,0 +1,797 @@
+
+// exhaustive.h
+// This is a C++ library for determining if a graph is f-choosable by exhaustively checking all list assignments.
+// The library is contained in one header file to enable use of inline functions.
+
+// Copyright 2017, Stephen G. Hartke
+// Licensed under the GPL version 3.
+
+
+#pragma once  // for compilers that support this
+#ifndef EXHAUSTIVE_H__OHJAEZEISHIEQUEIVOHTH  // include guard
+#define EXHAUSTIVE_H__OHJAEZEISHIEQUEIVOHTH
+
+
+#include <string>
+#include <cstdio>  // for printf
+#include <thread>
+#include <atomic>
+#include <memory>  // for unique_ptr
+#include <random>  // for the probes of splitlevel_heuristic
+#include <cmath>  // for sqrt
+#include <chrono>  // for timing the calibration of estimate_exhaustive
+#include "fgraph.h"
+#include "bitarray.h"
+#include "neighborhood.h"
+#include "subgraph.h"
+#include "colorabilityclass.h"
+#include "listassignment.h"
+#include "automorphism.h"
+#include "checkpoint.h"
+#include "statistics.h"
+#include "taskpool.h"
+#include "estimator.h"
+#include "ordering.h"
+
+
+
+struct SearchTotals
+    // The counts of a search, which are combined over the residues by the coordinator (see coordinator.h).
+    // See ListAssignment for the meaning of each.
+{
+    unsigned long long int count, num_feasible_colorings;
+    unsigned long long int shared_count, shared_feasible_colorings;
+    unsigned long long int num_split_nodes, num_expanded_nodes;
+};
+
+
+struct SearchOptions
+    // The options that determine how the search is done, but not which list assignments are checked.
+{
+    int num_threads;
+    int cache_size;
+    int transposition_mb;
+    bool use_automorphisms;
+    bool use_hall_filter;
+    bool use_witness_pool;
+    Checkpointer *checkpointer;  // NULL if not checkpointing
+    std::string resume_filename;  // empty if not resuming
+    std::string statistics_filename;  // empty if not collecting statistics
+    int statistics_interval;
+    const std::atomic<bool> *cancel;  // stops the search when set by another thread (see ListAssignment::cancel); NULL if not used
+    SearchTotals *totals;  // set to the counts of the search if not NULL; not used with more than one thread
+    int progress_interval;  // the number of seconds between reports of the progress of the search; 0 for none; not used with more than one thread
+    const std::vector<int> *labels;  // the input label of each vertex if the fgraph was relabeled (see ordering.h); NULL if not
+};
+
+
+template <typename bitarray_t>
+void set_neighbors(const fGraph& G,std::vector<bitarray_t> &neighbors)
+    // create the neighbor bit masks for G from its rows
+{
+    neighbors.resize(G.n);
+    for (int i=G.n-1; i>=0; i--)
+    {
+        neighbors[i]=bitarray_from_words<bitarray_t>(G.get_row(i),G.words_per_row);
+        
+        /*
+        printf("%2d: ",i);
+        print_binary(neighbors[i],G.n);
+        printf("\n");
+        //*/
+    }
+}
+
+
+template <typename bitarray_t, typename statistics_t>
+void set_transposition_limit(ListAssignment<bitarray_t,statistics_t> &list_assignment,int transposition_mb,int num_threads)
+    // The memory limit is shared equally by the threads.
+{
+    if (transposition_mb>0)
+    {
+        list_assignment.transposition_table.max_entries=(size_t)-1;  // limited only by memory
+        list_assignment.transposition_table.max_bytes=((size_t)transposition_mb<<20)/num_threads;
+    }
+}
+
+
+template <typename bitarray_t, typename statistics_t>
+void set_hall_filter(ListAssignment<bitarray_t,statistics_t> &list_assignment,bool use_hall_filter)
+    // The cliques of the filter are found for each graph, since a reused ListAssignment keeps them.
+{
+    if (use_hall_filter)
+        list_assignment.hall_filter.compute(list_assignment.n,list_assignment.neighbors,list_assignment.color_info.size());
+    else
+        list_assignment.hall_filter.clear();
+}
+
+
+template <typename bitarray_t, typename statistics_t>
+void set_feasibility_cache(ListAssignment<bitarray_t,statistics_t> &list_assignment,int cache_size)
+{
+    if (cache_size>0)
+        list_assignment.feasibility_cache.resize(cache_size,list_assignment.color_info.size());
+    else
+        list_assignment.feasibility_cache.clear();
+}
+
+
+template <typename bitarray_t, typename statistics_t>
+void set_witness_pool(ListAssignment<bitarray_t,statistics_t> &list_assignment,bool use_witness_pool)
+{
+    if (use_witness_pool)
+        list_assignment.witness_pool.resize(list_assignment.color_info.size());
+    else
+        list_assignment.witness_pool.clear();
+}
+
+
+/* estimate_search averages the estimates of random probes of the search (see estimator.h).
+ * It is used for the --estimate mode of estimate_exhaustive, and for the estimated count of the progress reports.
+ * The random numbers have a fixed seed, so that the estimates can be repeated.
+ */
+
+const int progress_probes=1000;  // the probes for the estimated count of the progress reports
+
+
+template <typename bitarray_t>
+SearchEstimate estimate_search(const fGraph& G,const std::vector<bitarray_t> &neighbors,const NeighborhoodTable<bitarray_t> &neighborhood,
+                               int num_probes,const std::vector<int> *labels,FILE *out)
+    // If a probe reaches a bad list assignment, it is printed to out with labels, and the probes stop.
+{
+    ListAssignment<bitarray_t> probe(G.n,neighbors,neighborhood,G.f,NULL);  // the probes report nothing
+    std::mt19937 random(1);
+    
+    SearchEstimate estimate;
+    for (int k=0; (k<num_probes) && !estimate.found_bad_list; k++)
+    {
+        if (k>0)
+            probe.reset(G.n);
+        estimate.add(probe.probe(random,estimate.found_bad_list));
+    }
+    if (estimate.found_bad_list)
+    {
+        probe.out=out;
+        probe.labels=labels;
+        probe.print_bad_list();
+    }
+    
+    return estimate;
+}
+
+
+template <typename bitarray_t, typename statistics_t>
+bool verify_with_threads(const fGraph& G,const std::vector<bitarray_t> &neighbors,const NeighborhoodTable<bitarray_t> &neighborhood,
+                         const SearchOptions &options,OrbitPruner<bitarray_t> *orbit_pruner,FILE *out)
+    // We search for a bad list assignment using num_threads threads.
+    // Each thread has its own colorability class stack; thread 0 starts at the root, and the others steal from it.
+{
+    int num_threads=options.num_threads;
+    TaskPool<SearchTask<bitarray_t> > pool(num_threads);
+    std::vector<std::thread> threads;
+    std::vector<unsigned long long int> count(num_threads,0), num_feasible_colorings(num_threads,0);
+    std::vector<unsigned long long int> cache_hits(num_threads,0), cache_misses(num_threads,0);
+    std::vector<unsigned long long int> transposition_hits(num_threads,0);
+    std::vector<unsigned long long int> hall_hits(num_threads,0), hall_misses(num_threads,0);
+    std::vector<unsigned long long int> witness_hits(num_threads,0), witness_misses(num_threads,0);
+    std::vector<char> cancelled(num_threads,false);
+    std::vector<statistics_t> statistics(num_threads);
+    
+    for (int t=0; t<num_threads; t++)
+        threads.push_back(std::thread([&,t]()
+        {
+            ListAssignment<bitarray_t,statistics_t> list_assignment(G.n,neighbors,neighborhood,G.f,out);
+            list_assignment.pool=&pool;
+            list_assignment.thread_id=t;
+            list_assignment.orbit_pruner=orbit_pruner;
+            list_assignment.cancel=options.cancel;
+            list_assignment.labels=options.labels;
+            set_feasibility_cache(list_assignment,options.cache_size);
+            set_transposition_limit(list_assignment,options.transposition_mb,num_threads);
+            set_hall_filter(list_assignment,options.use_hall_filter);
+            set_witness_pool(list_assignment,options.use_witness_pool);
+            if (!options.statistics_filename.empty())
+            {
+                char suffix[16];
+                sprintf(suffix,".%d",t);
+                list_assignment.statistics.set_output(options.statistics_filename+suffix,options.statistics_interval);
+            }
+            
+            bool has_task=(t==0);  // thread 0 searches from the root, which is how the stack is initialized
+            SearchTask<bitarray_t> *task;
+            while (has_task || pool.get_task(t,task))
+            {
+                if (!has_task)
+                {
+                    list_assignment.load_task(*task);
+                    delete task;
+                }
+                has_task=false;
+                
+                list_assignment.search();  // a bad list assignment stops the pool
+                pool.finish_task();
+            }
+            
+            count[t]=list_assignment.count;
+            num_feasible_colorings[t]=list_assignment.num_feasible_colorings;
+            cache_hits[t]=list_assignment.feasibility_cache.hits;
+            cache_misses[t]=list_assignment.feasibility_cache.misses;
+            transposition_hits[t]=list_assignment.transposition_table.hits;
+            hall_hits[t]=list_assignment.hall_filter.hits;
+            hall_misses[t]=list_assignment.hall_filter.misses;
+            witness_hits[t]=list_assignment.witness_pool.hits;
+            witness_misses[t]=list_assignment.witness_pool.misses;
+            cancelled[t]=list_assignment.cancelled;
+            list_assignment.statistics.write_snapshot();
+            statistics[t]=list_assignment.statistics;
+        }));
+    
+    unsigned long long int total_count=0, total_num_feasible_colorings=0, total_cache_hits=0, total_cache_misses=0, total_transposition_hits=0;
+    unsigned long long int total_hall_hits=0, total_hall_misses=0, total_witness_hits=0, total_witness_misses=0;
+    bool any_cancelled=false;
+    for (int t=0; t<num_threads; t++)
+    {
+        threads[t].join();
+        total_count+=count[t];
+        total_num_feasible_colorings+=num_feasible_colorings[t];
+        total_cache_hits+=cache_hits[t];
+        total_cache_misses+=cache_misses[t];
+        total_transposition_hits+=transposition_hits[t];
+        total_hall_hits+=hall_hits[t];
+        total_hall_misses+=hall_misses[t];
+        total_witness_hits+=witness_hits[t];
+        total_witness_misses+=witness_misses[t];
+        any_cancelled|=cancelled[t];
+        if (t>0)
+            statistics[0].add(statistics[t]);
+    }
+    statistics[0].set_output(options.statistics_filename,options.statistics_interval);
+    statistics[0].write_snapshot();
+    fprintf(out,"Threads=%d donations=%ld steals=%ld\n",num_threads,pool.num_donations.load(),pool.num_steals.load());
+    if (options.cache_size>0)
+        fprintf(out,"Feasibility cache: hits=%llu misses=%llu\n",total_cache_hits,total_cache_misses);
+    if (options.transposition_mb>0)
+        fprintf(out,"Transposition table: subtrees skipped=%llu\n",total_transposition_hits);
+    if (options.use_hall_filter)
+        fprintf(out,"Hall filter: infeasible=%llu passed=%llu\n",total_hall_hits,total_hall_misses);
+    if (options.use_witness_pool)
+        fprintf(out,"Witness pool: hits=%llu misses=%llu\n",total_witness_hits,total_witness_misses);
+    
+    if (pool.stop_requested())
+        return false;  // a bad list assignment was found
+    if (any_cancelled)
+        return true;  // the caller knows the result is not valid
+    
+    fprintf(out,"All list assignments checked, final count=%llu, num_feasible_colorings=%llu\n",total_count,total_num_feasible_colorings);
+    return true;
+}
+
+
+template <typename bitarray_t, typename statistics_t>
+bool verify(const fGraph& G,const std::vector<bitarray_t> &neighbors,const NeighborhoodTable<bitarray_t> &neighborhood,
+            int res,int mod,int splitlevel,const SearchOptions &options,OrbitPruner<bitarray_t> *orbit_pruner,FILE *out)
+    // We search for a bad list assignment, with the statistics policy statistics_t.
+{
+    bool result;
+    if (options.num_threads>1)
+        result=verify_with_threads<bitarray_t,statistics_t>(G,neighbors,neighborhood,options,orbit_pruner,out);
+    else
+    {
+        // The ListAssignment of the previous graph checked by this thread is reused, unless it refers to other data structures.
+        thread_local std::unique_ptr<ListAssignment<bitarray_t,statistics_t> > reused;
+        if (reused && (&reused->neighbors==&neighbors) && (&reused->neighborhood==&neighborhood) && (&reused->f==&G.f))
+        {
+            reused->out=out;
+            reused->reset(G.n);
+        }
+        else
+            reused.reset(new ListAssignment<bitarray_t,statistics_t>(G.n,neighbors,neighborhood,G.f,out));
+        ListAssignment<bitarray_t,statistics_t> &list_assignment=*reused;
+        set_feasibility_cache(list_assignment,options.cache_size);
+        set_transposition_limit(list_assignment,options.transposition_mb,1);
+        set_hall_filter(list_assignment,options.use_hall_filter);
+        set_witness_pool(list_assignment,options.use_witness_pool);
+        list_assignment.orbit_pruner=orbit_pruner;
+        list_assignment.checkpointer=options.checkpointer;
+        list_assignment.cancel=options.cancel;
+        list_assignment.labels=options.labels;
+        list_assignment.statistics.set_output(options.statistics_filename,options.statistics_interval);
+        
+        std::unique_ptr<ProgressReporter> progress;
+        if (options.progress_interval>0)
+        {
+            SearchEstimate estimate=estimate_search(G,neighbors,neighborhood,progress_probes,options.labels,out);
+            fprintf(out,"Estimated count=%.4g (standard error %.2g) from %d probes, reporting progress every %d seconds\n",
+                    estimate.mean(),estimate.standard_error(),estimate.num_probes,options.progress_interval);
+            progress.reset(new ProgressReporter(estimate.mean(),options.progress_interval,out));
+        }
+        list_assignment.progress=progress.get();
+        
+        if (options.resume_filename.empty())
+            result=list_assignment.verify(res,mod,splitlevel);
+        else
+        {
+            CheckpointState<bitarray_t> state;
+            if (!read_checkpoint(options.resume_filename,state,G.n,neighbors,neighborhood))
+            {
+                printf("Could not read the checkpoint %s.\n",options.resume_filename.c_str());
+                exit(8);
+            }
+            if (state.has_orbits!=(orbit_pruner!=NULL))
+            {
+                printf("-a must be used when resuming if and only if it was used for the checkpoint.\n");
+                exit(8);
+            }
+            if (orbit_pruner!=NULL)
+            {
+                orbit_pruner->num_searched=state.orbits_searched;
+                orbit_pruner->num_skipped=state.orbits_skipped;
+                orbit_pruner->seen.insert(state.orbits_seen.begin(),state.orbits_seen.end());
+            }
+            fprintf(out,"Resuming from %s at count=%llu\n",options.resume_filename.c_str(),state.count);
+            if (progress)
+                progress->start(state.count);
+            result=list_assignment.resume(state,res,mod,splitlevel);
+        }
+        
+        list_assignment.progress=NULL;
+        list_assignment.statistics.write_snapshot();
+        if (options.totals!=NULL)
+        {
+            options.totals->count=list_assignment.count;
+            options.totals->num_feasible_colorings=list_assignment.num_feasible_colorings;
+            options.totals->shared_count=list_assignment.shared_count;
+            options.totals->shared_feasible_colorings=list_assignment.shared_feasible_colorings;
+            options.totals->num_split_nodes=list_assignment.num_split_nodes;
+            options.totals->num_expanded_nodes=list_assignment.num_expanded_nodes;
+        }
+        if (options.cache_size>0)
+            fprintf(out,"Feasibility cache: hits=%llu misses=%llu evictions=%llu\n",
+                   list_assignment.feasibility_cache.hits,list_assignment.feasibility_cache.misses,list_assignment.feasibility_cache.evictions);
+        if (options.transposition_mb>0)
+            fprintf(out,"Transposition table: subtrees skipped=%llu entries=%lu bytes=%lu evictions=%llu\n",
+                   list_assignment.transposition_table.hits,list_assignment.transposition_table.size(),
+                   list_assignment.transposition_table.bytes,list_assignment.transposition_table.evictions);
+        if (options.use_hall_filter)
+            fprintf(out,"Hall filter: infeasible=%llu passed=%llu cliques=%lu\n",
+                   list_assignment.hall_filter.hits,list_assignment.hall_filter.misses,list_assignment.hall_filter.cliques.size());
+        if (options.use_witness_pool)
+            fprintf(out,"Witness pool: hits=%llu misses=%llu\n",list_assignment.witness_pool.hits,list_assignment.witness_pool.misses);
+    }
+    
+    return result;
+}
+
+
+template <typename bitarray_t>
+bool search_exhaustive(const fGraph& G,int res,int mod,int splitlevel,const SearchOptions &options,FILE *out)
+    // We test if the fgraph G is f-choosable, and report the search to out, but not the verdict.
+    // If the search is stopped by options.cancel, true is returned (see is_fchoosable_exhaustive).
+{
+    // These are kept by each thread for the following graphs, so that the search can reuse its memory (see verify).
+    thread_local std::vector<bitarray_t> neighbors;
+    thread_local NeighborhoodTable<bitarray_t> neighborhood(0,neighbors);
+    //unsigned long int count;
+    
+    set_neighbors(G,neighbors);
+    neighborhood.compute(G.n);  // shared by all of the subgraph generators
+    
+    AutomorphismGroup<bitarray_t> *group=NULL;
+    OrbitPruner<bitarray_t> *orbit_pruner=NULL;
+    if (options.use_automorphisms)
+    {
+        group=new AutomorphismGroup<bitarray_t>(G.n,neighbors,G.f);
+        orbit_pruner=new OrbitPruner<bitarray_t>(*group);
+        fprintf(out,"Automorphism group: order=%.15Lg generators=%lu vertex orbits=%d\n",
+               group->order,group->generators.size(),group->num_vertex_orbits);
+    }
+    
+    bool result;
+    if (options.statistics_filename.empty())
+        result=verify<bitarray_t,NoStatistics>(G,neighbors,neighborhood,res,mod,splitlevel,options,orbit_pruner,out);
+    else
+        result=verify<bitarray_t,SearchStatistics>(G,neighbors,neighborhood,res,mod,splitlevel,options,orbit_pruner,out);
+    
+    if (options.use_automorphisms)
+    {
+        fprintf(out,"Symmetry: level 0 classes searched=%llu skipped=%llu\n",orbit_pruner->num_searched,orbit_pruner->num_skipped);
+        delete orbit_pruner;
+        delete group;
+    }
+    
+    return result;
+}
+
+
+template <typename bitarray_t>
+bool is_fchoosable_exhaustive(const fGraph& G,int res,int mod,int splitlevel,const SearchOptions &options,FILE *out)
+    // We test if the fgraph G is f-choosable, and report to out.
+    // If the search is stopped by options.cancel, false is returned, and the caller should ignore the result.
+{
+    bool result=search_exhaustive<bitarray_t>(G,res,mod,splitlevel,options,out);
+    
+    if (result && (options.cancel!=NULL) && options.cancel->load())
+    {
+        fprintf(out,"The exhaustive search was cancelled.\n");
+        return false;
+    }
+    
+    if (result)
+    {
+        fprintf(out,"This graph is f-choosable!\n");
+        return true;
+    }
+    else
+    {
+        fprintf(out,"This graph is NOT f-choosable!\n");
+        return false;
+    }
+}
+
+
+template <typename call_t>
+typename call_t::result_type dispatch_bitarray(const fGraph& G,const call_t &call)
+    // Runs call with the narrowest bitarray that holds the vertices of G, so that small graphs are as fast as possible.
+    // call_t has a member template run<bitarray_t>() that calls the templated version of a function of this file.
+{
+    if (G.n<=max_vertices<uint32_t>())
+        return call.template run<uint32_t>();
+    if (G.n<=max_vertices<uint64_t>())
+        return call.template run<uint64_t>();
+    if (G.n<=max_vertices<bitarray128>())
+        return call.template run<bitarray128>();
+    if (G.n<=max_vertices<MultiWordBitArray<4> >())
+        return call.template run<MultiWordBitArray<4> >();
+    
+    printf("Graphs with more than %d vertices are not supported.\n",max_vertices<MultiWordBitArray<4> >());
+    exit(9);
+}
+
+
+struct ExhaustiveCall
+{
+    typedef bool result_type;
+    const fGraph& G;
+    int res, mod, splitlevel;
+    const SearchOptions &options;
+    FILE *out;
+    bool report_verdict;
+    
+    template <typename bitarray_t>
+    bool run() const
+    {
+        if (report_verdict)
+            return is_fchoosable_exhaustive<bitarray_t>(G,res,mod,splitlevel,options,out);
+        return search_exhaustive<bitarray_t>(G,res,mod,splitlevel,options,out);
+    }
+};
+
+
+bool is_fchoosable_exhaustive(const fGraph& G,int res,int mod,int splitlevel,const SearchOptions &options,FILE *out)
+{
+    ExhaustiveCall call={G,res,mod,splitlevel,options,out,true};
+    return dispatch_bitarray(G,call);
+}
+
+
+bool search_exhaustive(const fGraph& G,int res,int mod,int splitlevel,const SearchOptions &options,FILE *out)
+    // For callers that report the verdict themselves, such as the coordinator of the residues (see coordinator.h).
+{
+    ExhaustiveCall call={G,res,mod,splitlevel,options,out,false};
+    return dispatch_bitarray(G,call);
+}
+
+
+/* With --estimate, the search is not done, but its final count is estimated by num_probes random probes (see estimate_search),
+ * and its rate is measured by searching up to estimate_calibration_count nodes, which gives an estimate of its running time.
+ * The search is as it would be without -a and -T, with a feasibility cache of options.cache_size entries.
+ * A search that finishes within the calibration gives the exact count instead.
+ */
+
+const unsigned long long int estimate_calibration_count=1<<20;
+
+
+struct Calibration
+    // The start of a search that measures its rate.
+{
+    unsigned long long int count;
+    double seconds;
+    bool finished;  // whether the whole search was done
+    bool fchoosable;  // if finished, the result of the search
+    
+    double rate() const;
+};
+
+
+inline
+double Calibration::rate() const
+{
+    return count/std::max(seconds,1e-9);
+}
+
+
+template <typename bitarray_t>
+Calibration calibrate_search(const fGraph& G,const std::vector<bitarray_t> &neighbors,const NeighborhoodTable<bitarray_t> &neighborhood,
+                             unsigned long long int max_count,int cache_size,const std::vector<int> *labels,FILE *out)
+{
+    int sum=0;
+    for (int i=G.n-1; i>=0; i--)
+        sum+=G.f[i];
+    ListAssignment<bitarray_t> list_assignment(G.n,neighbors,neighborhood,G.f,out);
+    set_feasibility_cache(list_assignment,cache_size);
+    list_assignment.labels=labels;
+    list_assignment.max_count=max_count;
+    
+    Calibration calibration;
+    std::chrono::steady_clock::time_point start=std::chrono::steady_clock::now();
+    calibration.fchoosable=list_assignment.verify(-1,-1,sum+1);  // never split
+    calibration.seconds=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+    calibration.count=list_assignment.count;
+    calibration.finished=!list_assignment.cancelled;
+    return calibration;
+}
+
+
+template <typename bitarray_t>
+int estimate_exhaustive(const fGraph& G,int num_probes,const SearchOptions &options,FILE *out)
+    // Returns 0 if a probe found a bad list assignment, 1 if the calibration finished the search, and 2 otherwise.
+{
+    std::vector<bitarray_t> neighbors;
+    NeighborhoodTable<bitarray_t> neighborhood(0,neighbors);
+    set_neighbors(G,neighbors);
+    neighborhood.compute(G.n);
+    
+    SearchEstimate estimate=estimate_search(G,neighbors,neighborhood,num_probes,options.labels,out);
+    if (estimate.found_bad_list)
+    {
+        fprintf(out,"A probe found a bad list assignment.\n");
+        fprintf(out,"This graph is NOT f-choosable!\n");
+        return 0;
+    }
+    fprintf(out,"Estimated count=%.4g (standard error %.2g) from %d probes\n",estimate.mean(),estimate.standard_error(),estimate.num_probes);
+    fprintf(out,"The estimates of the probes are heavy tailed, so the count is often several standard errors above the estimate.\n");
+    
+    Calibration calibration=calibrate_search(G,neighbors,neighborhood,estimate_calibration_count,options.cache_size,options.labels,out);
+    if (calibration.finished)
+    {
+        fprintf(out,"The search finished within the calibration, in %.3f seconds.\n",calibration.seconds);
+        fprintf(out,"This graph is %sf-choosable!\n",calibration.fchoosable ? "" : "NOT ");
+        return calibration.fchoosable;
+    }
+    
+    double rate=calibration.rate();
+    char expected[64], error[64];
+    format_duration(estimate.mean()/rate,expected,sizeof(expected));
+    format_duration(estimate.standard_error()/rate,error,sizeof(error));
+    fprintf(out,"Calibration: %llu nodes in %.3f seconds, %.0f nodes per second\n",calibration.count,calibration.seconds,rate);
+    fprintf(out,"Estimated time=%s (standard error %s) with one thread\n",expected,error);
+    return 2;
+}
+
+
+struct EstimateCall
+{
+    typedef int result_type;
+    const fGraph& G;
+    int num_probes;
+    const SearchOptions &options;
+    FILE *out;
+    
+    template <typename bitarray_t>
+    int run() const { return estimate_exhaustive<bitarray_t>(G,num_probes,options,out); }
+};
+
+
+int estimate_exhaustive(const fGraph& G,int num_probes,const SearchOptions &options,FILE *out)
+{
+    EstimateCall call={G,num_probes,options,out};
+    return dispatch_bitarray(G,call);
+}
+
+
+/* With -o auto, each ordering of ordering.h is tried with ordering_probes random probes (see estimate_search)
+ * and a search of up to ordering_calibration_count nodes that measures its rate, and the ordering with the smallest estimated time is used.
+ * An ordering whose probes find a bad list assignment, or whose calibration finishes the search, is used right away.
+ * The rate is measured with the clock, so the choice can differ between runs.
+ */
+
+const int ordering_probes=100;
+const unsigned long long int ordering_calibration_count=1<<16;
+
+
+template <typename bitarray_t>
+VertexOrdering choose_ordering(const fGraph& G,int cache_size,FILE *out)
+{
+    std::vector<bitarray_t> neighbors;
+    NeighborhoodTable<bitarray_t> neighborhood(0,neighbors);
+    fGraph H;
+    std::vector<int> order;
+    
+    fprintf(out,"Choosing the ordering of the vertices by the estimated time of the search:\n");
+    VertexOrdering best=ORDER_INPUT;
+    double best_seconds=-1;
+    for (int k=0; k<num_vertex_orderings; k++)
+    {
+        VertexOrdering ordering=(VertexOrdering)k;
+        vertex_order(G,ordering,order);
+        H.relabel_from(G,order);
+        set_neighbors(H,neighbors);
+        neighborhood.compute(H.n);
+        
+        double seconds;
+        SearchEstimate estimate=estimate_search(H,neighbors,neighborhood,ordering_probes,NULL,NULL);  // the probes and the calibrations report nothing
+        if (estimate.found_bad_list)
+        {
+            fprintf(out,"  %s: a probe found a bad list assignment\n",ordering_name(ordering));
+            seconds=0;
+        }
+        else
+        {
+            Calibration calibration=calibrate_search(H,neighbors,neighborhood,ordering_calibration_count,cache_size,NULL,NULL);
+            if (calibration.finished)
+            {
+                fprintf(out,"  %s: the search finished within the calibration, in %.3f seconds\n",ordering_name(ordering),calibration.seconds);
+                seconds=0;
+            }
+            else
+            {
+                seconds=estimate.mean()/calibration.rate();
+                fprintf(out,"  %s: estimated count=%.4g at %.0f nodes per second, estimated time=%.4g seconds\n",
+                        ordering_name(ordering),estimate.mean(),calibration.rate(),seconds);
+            }
+        }
+        
+        if ((best_seconds<0) || (seconds<best_seconds))
+        {
+            best=ordering;
+            best_seconds=seconds;
+        }
+        if (seconds==0)
+            break;  // no ordering can be better
+    }
+    
+    return best;
+}
+
+
+struct OrderingCall
+{
+    typedef VertexOrdering result_type;
+    const fGraph& G;
+    int cache_size;
+    FILE *out;
+    
+    template <typename bitarray_t>
+    VertexOrdering run() const { return choose_ordering<bitarray_t>(G,cache_size,out); }
+};
+
+
+VertexOrdering choose_ordering(const fGraph& G,int cache_size,FILE *out)
+{
+    OrderingCall call={G,cache_size,out};
+    return dispatch_bitarray(G,call);
+}
+
+
+/* With -r/-m, the nodes at splitlevel are dealt out to the residues in turn, so each residue gets about num_nodes/mod of them.
+ * If splitlevel is too shallow, there are too few nodes, and the residue that gets the largest subtrees takes far longer than the others.
+ * If it is too deep, every residue repeats the search of the levels above splitlevel.
+ *
+ * splitlevel_heuristic chooses the shallowest level with at least splitlevel_nodes_per_residue*mod nodes
+ * whose residues are estimated to be balanced.  The nodes of each level are counted by searching the levels above it,
+ * expanding no node at the level, which is the same as using a residue equal to the modulus.
+ * Then the subtrees of splitlevel_samples random nodes of the level are searched, up to splitlevel_probe_count nodes each,
+ * and the imbalance is estimated as the coefficient of variation of the sum of num_nodes/mod subtrees,
+ * which is the coefficient of variation of the sampled subtree sizes divided by sqrt(num_nodes/mod).
+ *
+ * The random numbers have a fixed seed, so that the separate processes of the residues all choose the same splitlevel.
+ * The probes do not use the automorphisms, the caches, or the transposition table.
+ */
+
+const int splitlevel_nodes_per_residue=100;
+const int splitlevel_samples=16;
+const unsigned long long int splitlevel_probe_count=100000;  // the largest search of one probe
+const double splitlevel_max_imbalance=0.1;
+
+
+template <typename bitarray_t>
+int splitlevel_heuristic(const fGraph& G,int mod,FILE *out)
+{
+    std::vector<bitarray_t> neighbors;
+    NeighborhoodTable<bitarray_t> neighborhood(0,neighbors);
+    set_neighbors(G,neighbors);
+    neighborhood.compute(G.n);
+    
+    ListAssignment<bitarray_t> probe(G.n,neighbors,neighborhood,G.f,NULL);  // the probes report nothing
+    std::mt19937 random(1);
+    
+    int sum=0;
+    for (int i=G.n-1; i>=0; i--)
+        sum+=G.f[i];
+    
+    fprintf(out,"Choosing the splitlevel for mod=%d, with at least %d nodes per residue and an estimated imbalance of at most %.2f:\n",
+            mod,splitlevel_nodes_per_residue,splitlevel_max_imbalance);
+    int splitlevel=-1;
+    int deepest=-1;  // the deepest level whose nodes were counted
+    for (int level=0; (level<sum) && (splitlevel==-1); level++)
+    {
+        probe.reset(G.n);
+        probe.max_count=splitlevel_probe_count;
+        bool found_bad_list=!probe.verify(1,1,level);  // the residue 1 modulo 1 never expands a node
+        if (probe.cancelled)
+        {
+            fprintf(out,"  level %d: more than %llu nodes above the level, so the deeper levels are not probed\n",level,splitlevel_probe_count);
+            break;
+        }
+        if (found_bad_list)
+        {
+            fprintf(out,"  level %d: a bad list assignment is above the level, so the split does not matter\n",level);
+            splitlevel=level;
+            break;
+        }
+        
+        unsigned long long int num_nodes=probe.num_split_nodes;
+        unsigned long long int above=probe.count;
+        if (num_nodes==0)
+        {
+            fprintf(out,"  level %d: no nodes\n",level);
+            break;
+        }
+        deepest=level;
+        if (num_nodes<(unsigned long long int)splitlevel_nodes_per_residue*mod)
+        {
+            fprintf(out,"  level %d: %llu nodes, which is too few\n",level,num_nodes);
+            continue;
+        }
+        
+        double total=0, total_squares=0;
+        int num_capped=0;  // the samples whose subtrees were larger than the probe
+        for (int k=0; k<splitlevel_samples; k++)
+        {
+            int node=(int)(random()%num_nodes);
+            probe.reset(G.n);
+            probe.max_count=above+splitlevel_probe_count;
+            probe.verify(node,(int)num_nodes,level);  // expands only one node
+            num_capped+=probe.cancelled;
+            double size=(double)(probe.count-probe.shared_count);
+            total+=size;
+            total_squares+=size*size;
+        }
+        double mean=total/splitlevel_samples;
+        double deviation=sqrt(std::max(0.0,total_squares/splitlevel_samples-mean*mean));
+        double imbalance=(deviation/mean)/sqrt((double)num_nodes/mod);
+        fprintf(out,"  level %d: %llu nodes, sampled subtrees mean=%.1f sd=%.1f (%d larger than the probe), estimated imbalance=%.3f\n",
+                level,num_nodes,mean,deviation,num_capped,imbalance);
+        if (imbalance<=splitlevel_max_imbalance)
+            splitlevel=level;
+    }
+    
+    if (splitlevel==-1)
+    {
+        splitlevel=(deepest>=0) ? deepest : 0;
+        fprintf(out,"  No level is balanced, so the deepest level probed is used.\n");
+    }
+    return splitlevel;
+}
+
+
+struct SplitlevelCall
+{
+    typedef int result_type;
+    const fGraph& G;
+    int mod;
+    FILE *out;
+    
+    template <typename bitarray_t>
+    int run() const { return splitlevel_heuristic<bitarray_t>(G,mod,out); }
+};
+
+
+int splitlevel_heuristic(const fGraph& G,int mod,FILE *out)
+{
+    SplitlevelCall call={G,mod,out};
+    return dispatch_bitarray(G,call);
+}
+
+
+#endif  // EXHAUSTIVE_H__OHJAEZEISHIEQUEIVOHTH
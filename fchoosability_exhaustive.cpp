@@ -8,12 +8,12 @@
 #include <string>
 #include <cstdio>  // for printf
 #include <ctime>  // for reporting runtime
-#include <unistd.h>  // to use getopt to parse the command line
+#include <getopt.h>  // to use getopt_long to parse the command line
 #include "fgraph.h"
-#include "bitarray.h"
-#include "subgraph.h"
-#include "colorabilityclass.h"
-#include "listassignment.h"
+#include "exhaustive.h"
+#include "coordinator.h"
+#include "graphinput.h"
+#include "pipeline.h"
 
 
 /* Command line parameters can be used for parallelization.
@@ -22,70 +22,197 @@
  * This is done by chopping the search tree at a given height (given by the variable splitlevel),
  * counting the nodes (ie, precolorings) at that level, and only expanding those with the specified residue.
  * 
+ * Without -s, the splitlevel is chosen by probing the search (see splitlevel_heuristic in exhaustive.h).
+ * The choice depends on the modulus, so -s should be given when runs with different moduli are combined as below.
+ * 
  * One advantage is that modulo classes work as expected, in that 1 (mod 4) and 3 (mod 4) gives 1 (mod 2).
  * Note that there's a limit to this, as the number of nodes on the level being split is only 100*modulus.
  * 
  * If the modulus is larger than the number of nodes at that level, the last residues (up to mod-1) are the ones that are actually examined, since we start counting at the mod-1 and count down.
+ *
+ * -P runs all of the residues of -m in forked processes, at most the given number at a time, instead of one residue given by -r
+ * (see coordinator.h).  The first bad list assignment stops the other processes, a process that fails is started again,
+ * and the counts of the residues are checked to cover the whole search.  This stops with exit code 11 if that fails.
+ *
+ * Alternatively, -t specifies a number of threads that share the search within this process.
+ * The threads balance the load by work stealing (see taskpool.h), so no splitlevel is needed.
+ * This cannot be combined with -r/-m, since the odometer depends on the order in which the nodes are searched.
+ *
+ * -c sets the number of entries in the cache of feasible colorings (see feasibilitycache.h).
+ * The default of 0 disables the cache, which only saves time when the checks are expensive.  With -t, each thread has its own cache of this size.
+ *
+ * -T sets the memory limit in megabytes of the transposition table, which records the states of the search
+ * whose subtrees have no bad list assignment (see check_transposition_table in listassignment.h).
+ * The default of 0 disables the table.  With -t, the limit is divided between the threads.  Each level of the stack stops using the table
+ * if it saves too few nodes for the cost of its keys, so the table costs little where it does not help.
+ * Skipped subtrees are not counted, so the final count is smaller with the table.
+ *
+ * -H checks that every vertex, and the vertices of each maximal clique, have enough colors in their lists
+ * before searching for a feasible coloring of a partial list assignment (see hall.h).  This does not change the final count.
+ *
+ * -W keeps the last few feasible colorings found on each level of the stack, and checks whether one of them also colors
+ * the next colorability class on the level before searching for a feasible coloring (see witnesspool.h).  This does not change the final count.
+ *
+ * -a computes the automorphisms of the fgraph, and searches only one colorability class of each orbit on level 0
+ * of the stack (see automorphism.h).  This also makes the final count smaller.
+ *
+ * --checkpoint file (or -C) saves the state of the search to file every --checkpoint-interval seconds (or -I, default 3600),
+ * and whenever SIGUSR1 or SIGTERM is received; after SIGTERM the program stops with exit code 10 (see checkpoint.h).
+ * --resume file (or -R) skips the input graphs up to the one that was being searched when file was saved, and continues its search.
+ * The search continues exactly where it stopped, so the final count is the same as without interruption
+ * (except with -T, since the transposition table is not saved).
+ * Both cannot be combined with -t, and a resumed search must use the same -r/-m/-s.
+ *
+ * --statistics file (or -S) counts the nodes, feasibility checks, and other events of the search (see statistics.h),
+ * and writes them to file every --statistics-interval seconds (or -i, default 60) and at the end of the search.
+ * With -t, thread t writes its own snapshots to file.t, and the totals are written to file at the end.
+ * Without --statistics, the search is compiled without any counting.
+ *
+ * -p specifies a number of workers that check different graphs of the input at the same time (see pipeline.h).
+ * The output of each graph is written in the order of the input, or in the order the graphs are finished with -u.
+ * This is meant for inputs with many graphs, and cannot be combined with -t, --checkpoint, --resume, or --statistics.
+ *
+ * --estimate probes (or -E) does not search, but estimates the final count of the search from the given number of random probes,
+ * and its running time from a short search (see estimate_exhaustive in exhaustive.h).  The estimate is of the search without -a and -T,
+ * and so --estimate cannot be combined with them, or with -r/-m, -P, -t, --checkpoint, --resume, or --statistics.
+ * --progress seconds (or -G) instead reports the count of the search every given number of seconds,
+ * with the time remaining until it reaches the count estimated by the probes.
+ * It cannot be combined with -r/-m, -P, -t, -p, -a, -T, or --estimate.
+ *
+ * -o relabels the vertices of each graph before it is searched, with the degeneracy, bfs, or bandwidth ordering (see ordering.h),
+ * and bad list assignments are printed with the labels of the input.  The default is the input order.
+ * -o auto estimates the time of the search with each ordering, and uses the fastest (see choose_ordering in exhaustive.h).
+ * The choice depends on the clock, so -o auto cannot be used with -r/-m without -P, or with --checkpoint or --resume,
+ * which need the same ordering in every run.
  */
 
 
-
-bool is_fchoosable(const fGraph& G,int res,int mod,int splitlevel)
-    // We test if the fgraph G is f-choosable.
+int check_graph(const char *line,size_t length,fGraph &G,int res,int mod,int splitlevel_arg,int num_processes,int num_probes,VertexOrdering ordering,
+                const SearchOptions &options,FILE *out)
+    // We read the fgraph6 string of the given length at line into G, and test if it is f-choosable, reporting to out.
+    // A line that is not in fgraph6 format is reported and skipped, and 0 is returned, as it is not shown to be f-choosable.
 {
-    std::vector<bitarray> neighbors;
-    //unsigned long int count;
+    double start,end;  // for reporting CPU runtime
+    int splitlevel;
+    int val;
     
-    // create the neighbor bit masks for G
-    neighbors.resize(G.n);
-    for (int i=G.n-1; i>=0; i--)
+    start=cpu_seconds()+children_cpu_seconds();  // record starting time, including the processes of the residues (see coordinator.h)
+    
+    if (!G.read_fgraph6(line,length))
     {
-        neighbors[i]=0;
-        for (int j=G.n-1; j>=0; j--)
-        {
-            neighbors[i]<<=1;
-            if ((j!=i) && (G.get_adj(i,j)!=0))  // i and j are different and adjacent
-                neighbors[i]|=1;  // set the low order bit
-        }
+        fprintf(out,"Skipping a line that is not in fgraph6 format: %.*s\n\n",(int)length,line);
+        return 0;  // rather than checking a graph with an edge for each bad character
+    }
+    
+    fprintf(out,"Input read: n=%d %.*s\n",G.n,(int)length,line);
+    
+    std::vector<int> labels;  // the input label of each vertex of G
+    SearchOptions graph_options=options;
+    if (ordering!=ORDER_INPUT)
+    {
+        if (ordering==ORDER_AUTO)
+            ordering=choose_ordering(G,options.cache_size,out);  // see exhaustive.h
+        vertex_order(G,ordering,labels);
+        fGraph input_G(G);
+        G.relabel_from(input_G,labels);
+        graph_options.labels=&labels;
         
-        /*
-        printf("%2d: ",i);
-        print_binary(neighbors[i],G.n);
-        printf("\n");
-        //*/
+        fprintf(out,"Relabeled with the %s ordering; the input labels of the vertices are",ordering_name(ordering));
+        for (int v=0; v<G.n; v++)
+            fprintf(out," %d",labels[v]);
+        fprintf(out,"\n");
     }
     
-    ListAssignment list_assignment(G.n,neighbors,G.f);
-    if (list_assignment.verify(res,mod,splitlevel))
+    if (mod==-1)  // not using parallelization
     {
-        printf("This graph is f-choosable!\n");
-        return true;
+        int sum=0;
+        for (int i=G.n-1; i>=0; i--)
+            sum+=G.f[i];
+        splitlevel=sum+1;  // will never reach this level
+        fprintf(out,"not parallelizing\n");
     }
-    else
+    else 
     {
-        printf("This graph is NOT f-choosable!\n");
-        return false;
+        if (splitlevel_arg!=-1)
+            splitlevel=splitlevel_arg;
+        else
+            splitlevel=splitlevel_heuristic(G,mod,out);  // see exhaustive.h
+        fprintf(out,"parallelizing with splitlevel=%d\n",splitlevel);
     }
+    
+    if (options.checkpointer!=NULL)
+        options.checkpointer->start(std::string(line,length),res,mod,splitlevel);
+    
+    if (num_probes>0)
+        val=estimate_exhaustive(G,num_probes,graph_options,out);  // see exhaustive.h
+    else if (num_processes>0)
+        val=is_fchoosable_split(G,mod,splitlevel,num_processes,graph_options,out);
+    else
+        val=is_fchoosable_exhaustive(G,res,mod,splitlevel,graph_options,out);
+    
+    end=cpu_seconds()+children_cpu_seconds();
+    fprintf(out,"    CPU time used: %.3f seconds\n\n",end-start);
+    
+    return val;
 }
 
 
 int main(int argc, char *argv[])
 {
-    std::string line_in;
+    const char *line;
+    size_t length;
     fGraph G;
     int val=0;
-    clock_t start,end;  // for reporting CPU runtime
     
-    int res,mod,splitlevel_arg,splitlevel;  // for parallelizing
+    int res,mod,splitlevel_arg;  // for parallelizing
+    SearchOptions options;
+    std::string checkpoint_filename;
+    int checkpoint_interval;
+    int num_workers;
+    bool ordered;
+    int num_processes;
+    int num_probes;
+    VertexOrdering ordering;
+    std::string ordering_arg;
     int opt;  // for parsing the command line
     
     // defaults
     splitlevel_arg=-1;
     res=-1;
     mod=-1;
+    options.num_threads=1;
+    options.cache_size=0;
+    options.transposition_mb=0;
+    options.use_automorphisms=false;
+    options.use_hall_filter=false;
+    options.use_witness_pool=false;
+    options.checkpointer=NULL;
+    options.cancel=NULL;
+    options.totals=NULL;
+    options.progress_interval=0;
+    options.labels=NULL;
+    checkpoint_interval=3600;
+    options.statistics_interval=60;
+    num_workers=1;
+    ordered=true;
+    num_processes=0;  // no coordinator
+    num_probes=0;  // search instead of estimating
+    ordering_arg="input";
+    
+    const struct option long_options[]=
+        {
+            {"checkpoint",required_argument,NULL,'C'},
+            {"checkpoint-interval",required_argument,NULL,'I'},
+            {"resume",required_argument,NULL,'R'},
+            {"statistics",required_argument,NULL,'S'},
+            {"statistics-interval",required_argument,NULL,'i'},
+            {"estimate",required_argument,NULL,'E'},
+            {"progress",required_argument,NULL,'G'},
+            {NULL,0,NULL,0}
+        };
     
     // parse the command line
-    while ((opt=getopt(argc,argv,"r:m:s:"))!=-1)  // the colons indicate the options take required arguments
+    while ((opt=getopt_long(argc,argv,"r:m:s:t:c:T:aHWC:I:R:S:i:p:uP:E:G:o:",long_options,NULL))!=-1)  // the colons indicate the options take required arguments
     {
         switch (opt)
         {
@@ -98,10 +225,70 @@ int main(int argc, char *argv[])
             case 's':
                 sscanf(optarg,"%d",&splitlevel_arg);
                 break;
+            case 't':
+                sscanf(optarg,"%d",&options.num_threads);
+                break;
+            case 'c':
+                sscanf(optarg,"%d",&options.cache_size);
+                break;
+            case 'T':
+                sscanf(optarg,"%d",&options.transposition_mb);
+                break;
+            case 'a':
+                options.use_automorphisms=true;
+                break;
+            case 'H':
+                options.use_hall_filter=true;
+                break;
+            case 'W':
+                options.use_witness_pool=true;
+                break;
+            case 'C':
+                checkpoint_filename=optarg;
+                break;
+            case 'I':
+                sscanf(optarg,"%d",&checkpoint_interval);
+                break;
+            case 'R':
+                options.resume_filename=optarg;
+                break;
+            case 'S':
+                options.statistics_filename=optarg;
+                break;
+            case 'i':
+                sscanf(optarg,"%d",&options.statistics_interval);
+                break;
+            case 'p':
+                sscanf(optarg,"%d",&num_workers);
+                break;
+            case 'u':
+                ordered=false;
+                break;
+            case 'P':
+                sscanf(optarg,"%d",&num_processes);
+                break;
+            case 'E':
+                sscanf(optarg,"%d",&num_probes);
+                break;
+            case 'G':
+                sscanf(optarg,"%d",&options.progress_interval);
+                break;
+            case 'o':
+                ordering_arg=optarg;
+                break;
             case '?':
                 printf("Error parsing command line arguments; problem with option %c\n",optopt);
-                printf("USAGE: fchoosability_exhaustive -r residue -m modulus -s splitlevel\n");
+                printf("USAGE: fchoosability_exhaustive -r residue -m modulus -s splitlevel -t threads -c cache_entries -T megabytes -a -H -W -p workers -u -P processes\n");
+                printf("       -o input|degeneracy|bfs|bandwidth|auto [input_file]\n");
+                printf("       --checkpoint file --checkpoint-interval seconds --resume file\n");
+                printf("       --statistics file --statistics-interval seconds --estimate probes --progress seconds\n");
                 printf("-r and -m must be used together; -s can only be used if -r/-m also are.\n");
+                printf("-t cannot be used with -r/-m.\n");
+                printf("-p cannot be used with -t, --checkpoint, --resume, or --statistics.\n");
+                printf("-P requires -m and cannot be used with -r, -t, -p, --checkpoint, --resume, or --statistics.\n");
+                printf("--estimate cannot be used with -r/-m, -P, -t, -a, -T, --checkpoint, --resume, or --statistics.\n");
+                printf("--progress cannot be used with -r/-m, -P, -t, -p, -a, -T, or --estimate.\n");
+                printf("-o auto cannot be used with -r/-m without -P, or with --checkpoint or --resume.\n");
                 exit(8);
             default:
                 ;
@@ -109,7 +296,17 @@ int main(int argc, char *argv[])
     }
     printf("Parallelization parameters set: res=%d mod=%d splitlevel_arg=%d\n",res,mod,splitlevel_arg);
     
-    if ((res==-1) ^ (mod==-1))  // using bitwise xor here since there is no logical xor
+    if (num_processes!=0)
+    {
+        if ((num_processes<0) || (mod<1) || (res!=-1) || (options.num_threads>1) || (num_workers>1) ||
+            !checkpoint_filename.empty() || !options.resume_filename.empty() || !options.statistics_filename.empty())
+        {
+            printf("-P requires a positive number of processes and -m, and cannot be used with -r, -t, -p, --checkpoint, --resume, or --statistics.\n");
+            exit(8);
+        }
+        printf("Using up to %d processes for the %d residues\n",num_processes,mod);
+    }
+    else if ((res==-1) ^ (mod==-1))  // using bitwise xor here since there is no logical xor
     {
         printf("-r and -m must be used together\n");
         exit(8);
@@ -119,53 +316,179 @@ int main(int argc, char *argv[])
         printf("-s can only be used if -r and -m also are.\n");
         exit(8);
     }
+    if (options.num_threads<1)
+    {
+        printf("-t requires at least 1 thread.\n");
+        exit(8);
+    }
+    if ((options.num_threads>1) && (mod!=-1))
+    {
+        printf("-t cannot be used with -r and -m.\n");
+        exit(8);
+    }
+    if (options.cache_size<0)
+    {
+        printf("-c requires a nonnegative number of entries.\n");
+        exit(8);
+    }
+    if (options.transposition_mb<0)
+    {
+        printf("-T requires a nonnegative number of megabytes.\n");
+        exit(8);
+    }
+    if ((options.num_threads>1) && (!checkpoint_filename.empty() || !options.resume_filename.empty()))
+    {
+        printf("-t cannot be used with --checkpoint or --resume.\n");
+        exit(8);
+    }
+    if (checkpoint_interval<1)
+    {
+        printf("--checkpoint-interval requires a positive number of seconds.\n");
+        exit(8);
+    }
+    if (options.statistics_interval<1)
+    {
+        printf("--statistics-interval requires a positive number of seconds.\n");
+        exit(8);
+    }
+    if (num_workers<1)
+    {
+        printf("-p requires at least 1 worker.\n");
+        exit(8);
+    }
+    if ((num_workers>1) && ((options.num_threads>1) || !checkpoint_filename.empty() || !options.resume_filename.empty() || !options.statistics_filename.empty()))
+    {
+        printf("-p cannot be used with -t, --checkpoint, --resume, or --statistics.\n");
+        exit(8);
+    }
+    if (num_probes<0)
+    {
+        printf("--estimate requires a positive number of probes.\n");
+        exit(8);
+    }
+    if ((num_probes>0) && ((mod!=-1) || (num_processes>0) || (options.num_threads>1) || options.use_automorphisms || (options.transposition_mb>0) ||
+                           !checkpoint_filename.empty() || !options.resume_filename.empty() || !options.statistics_filename.empty()))
+    {
+        printf("--estimate cannot be used with -r/-m, -P, -t, -a, -T, --checkpoint, --resume, or --statistics.\n");
+        exit(8);
+    }
+    if (options.progress_interval<0)
+    {
+        printf("--progress requires a positive number of seconds.\n");
+        exit(8);
+    }
+    if ((options.progress_interval>0) && ((mod!=-1) || (num_processes>0) || (options.num_threads>1) || (num_workers>1) ||
+                                          options.use_automorphisms || (options.transposition_mb>0) || (num_probes>0)))
+    {
+        printf("--progress cannot be used with -r/-m, -P, -t, -p, -a, -T, or --estimate.\n");
+        exit(8);
+    }
+    if (ordering_arg=="input")
+        ordering=ORDER_INPUT;
+    else if (ordering_arg=="degeneracy")
+        ordering=ORDER_DEGENERACY;
+    else if (ordering_arg=="bfs")
+        ordering=ORDER_BFS;
+    else if (ordering_arg=="bandwidth")
+        ordering=ORDER_BANDWIDTH;
+    else if (ordering_arg=="auto")
+        ordering=ORDER_AUTO;
+    else
+    {
+        printf("-o must be input, degeneracy, bfs, bandwidth, or auto.\n");
+        exit(8);
+    }
+    if ((ordering==ORDER_AUTO) && (((mod!=-1) && (num_processes==0)) || !checkpoint_filename.empty() || !options.resume_filename.empty()))
+    {
+        printf("-o auto cannot be used with -r/-m without -P, or with --checkpoint or --resume.\n");
+        exit(8);
+    }
+    if (options.num_threads>1)
+        printf("Using %d threads\n",options.num_threads);
+    if (num_workers>1)
+        printf("Using %d workers, writing the results in %s order\n",num_workers,ordered ? "input" : "completion");
+    if (options.cache_size>0)
+        printf("Using a feasibility cache with %d entries\n",options.cache_size);
+    if (options.transposition_mb>0)
+        printf("Using a transposition table with %d MB\n",options.transposition_mb);
+    if (options.use_automorphisms)
+        printf("Using automorphisms to skip symmetric colorability classes\n");
+    if (options.use_hall_filter)
+        printf("Using the Hall filter before searching for feasible colorings\n");
+    if (options.use_witness_pool)
+        printf("Using the pool of witness colorings before searching for feasible colorings\n");
+    if (!checkpoint_filename.empty())
+    {
+        options.checkpointer=new Checkpointer(checkpoint_filename,checkpoint_interval);
+        printf("Writing checkpoints to %s every %d seconds\n",checkpoint_filename.c_str(),checkpoint_interval);
+    }
+    if (!options.statistics_filename.empty())
+        printf("Writing statistics to %s every %d seconds\n",options.statistics_filename.c_str(),options.statistics_interval);
+    if (num_probes>0)
+        printf("Estimating the search with %d probes instead of searching\n",num_probes);
+    if (options.progress_interval>0)
+        printf("Reporting the progress of the search every %d seconds\n",options.progress_interval);
+    if (ordering!=ORDER_INPUT)
+        printf("Relabeling the vertices with the %s ordering\n",ordering_name(ordering));
+    
+    std::string resume_graph;  // the graph being searched when the checkpoint was saved
+    int resume_res,resume_mod,resume_splitlevel;
+    if (!options.resume_filename.empty())
+    {
+        if (!read_checkpoint_header(options.resume_filename,resume_graph,resume_res,resume_mod,resume_splitlevel))
+        {
+            printf("Could not read the checkpoint %s.\n",options.resume_filename.c_str());
+            exit(8);
+        }
+        if ((resume_res!=res) || (resume_mod!=mod))
+        {
+            printf("The checkpoint was saved with -r %d -m %d, which must also be used to resume.\n",resume_res,resume_mod);
+            exit(8);
+        }
+        if ((splitlevel_arg!=-1) && (resume_splitlevel!=splitlevel_arg))
+            // without -s, the splitlevel is determined by the graph, which is the same one
+        {
+            printf("The checkpoint was saved with splitlevel=%d, which must also be used to resume.\n",resume_splitlevel);
+            exit(8);
+        }
+        printf("Resuming from %s with graph %s\n",options.resume_filename.c_str(),resume_graph.c_str());
+    }
     
     
     
     
     
-    // We read lines in from stdin.
+    // We read lines in from the input file given after the options, or from stdin (see graphinput.h).
     // Each line should be in fgraph6 format.
     // If a line starts with '>', then it is treated as a comment.
     
-    while (std::getline(std::cin,line_in))
+    GraphInput input((optind<argc) ? argv[optind] : NULL);
+    
+    if (num_workers>1)
     {
-        if (line_in.length()<=3)  // this line is too short, probably end of file
-            continue;
-        
-        if (line_in[0]=='>')  // treat this line as a comment
-            continue;
-        
-        start=clock();  // record starting time
-        
-        G.read_fgraph6_string(line_in);
-        
-        printf("Input read: n=%d %s\n",G.n,line_in.c_str());
-        
-        if (mod==-1)  // not using parallelization
-        {
-            int sum=0;
-            for (int i=G.n-1; i>=0; i--)
-                sum+=G.f[i];
-            splitlevel=sum+1;  // will never reach this level
-            printf("not parallelizing\n");
-        }
-        else 
+        std::vector<fGraph> worker_G(num_workers);  // each worker reuses its fGraph for the graphs that it checks
+        GraphPipeline pipeline(num_workers,ordered);
+        val=pipeline.run(input,stdout,
+            [&](int worker,const std::string &line,FILE *out)
+            {
+                return check_graph(line.data(),line.size(),worker_G[worker],res,mod,splitlevel_arg,num_processes,num_probes,ordering,options,out);
+            });
+    }
+    else
+        while (input.next_graph(line,length))  // skips comments and short lines
         {
-            if (splitlevel_arg!=-1)
-                splitlevel=splitlevel_arg;
-            else
-                splitlevel=3;
-                //splitlevel=splitlevel_heuristic(max_num_colors,num_verts_to_precolor,G,
-                //                                mod);
-            printf("parallelizing with splitlevel=%d\n",splitlevel);
+            if (!options.resume_filename.empty() && (resume_graph.compare(0,std::string::npos,line,length)!=0))
+            {
+                // This graph comes before the checkpoint, and so has already been checked.
+                printf("Skipping graph before the checkpoint: %.*s\n",(int)length,line);
+                continue;
+            }
+            
+            val=check_graph(line,length,G,res,mod,splitlevel_arg,num_processes,num_probes,ordering,options,stdout);
+            options.resume_filename.clear();  // the following graphs are searched from the beginning
         }
-        
-        val=is_fchoosable(G,res,mod,splitlevel);
-        
-        end=clock();
-        printf("    CPU time used: %.3f seconds\n\n",((double)(end-start))/CLOCKS_PER_SEC);
-    }
+    
+    delete options.checkpointer;
     
     return val;  // return true if the graph is f-choosable
 }
@@ -0,0 +1,333 @@
+
+// fchoosability_hybrid.cpp
+// C++ program to determine if a graph is f-choosable, using the Combinatorial Nullstellensatz,
+// and exhaustively checking all lists for the graphs where the Nullstellensatz is inconclusive.
+// Copyright 2017 by Stephen Hartke.
+// Licensed under the GPL version 3.
+
+#include <string>
+#include <cstdio>  // for printf and open_memstream
+#include <cstdlib>  // for free
+#include <ctime>  // for reporting runtime
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <getopt.h>  // to use getopt to parse the command line
+#include "fgraph.h"
+#include "nullstellensatz.h"
+#include "exhaustive.h"
+#include "graphinput.h"
+#include "pipeline.h"
+
+
+/* Each graph is first checked with the Nullstellensatz (see nullstellensatz.h), which is usually much faster,
+ * and the graphs where it is inconclusive are then checked exhaustively (see exhaustive.h).
+ * This is the same as running fchoosability_nullstellensatz and then fchoosability_exhaustive on its inconclusive graphs,
+ * but each graph is only read once.
+ *
+ * -b and -B give up on the compositions after the given number of compositions or seconds,
+ * so that a graph with many compositions that all fail moves on to the exhaustive search sooner.
+ * The default of 0 for both checks all of the compositions.
+ *
+ * -x races the two engines on separate threads instead, and the first one to decide the graph stops the other.
+ * The output of the graph is only that of the engine that decided it.
+ * The engines are not raced if the Nullstellensatz cannot be used, which is when sum(f[i]-1)<num_edges.
+ *
+ * -e and -c are as for fchoosability_nullstellensatz, and -f, -T, -a, -H, and -W are the -c, -T, -a, -H, and -W of fchoosability_exhaustive.
+ * -e alontarsi cannot be stopped, so it cannot be used with -b, -B, or -x, and it does not use -c.
+ *
+ * -p specifies a number of workers that check different graphs of the input at the same time (see pipeline.h).
+ * The output of each graph is written in the order of the input, or in the order the graphs are finished with -u.
+ */
+
+
+struct HybridOptions
+{
+    CheckOptions check;  // for the Nullstellensatz
+    SearchOptions search;  // for the exhaustive search
+    bool race;
+};
+
+
+enum Decider { DECIDED_BY_NONE, DECIDED_BY_NULLSTELLENSATZ, DECIDED_BY_EXHAUSTIVE };
+
+
+int never_split(const fGraph &G)
+    // The exhaustive search is not parallelized with a splitlevel, so we use a level that is never reached.
+{
+    int sum=0;
+    for (int i=G.n-1; i>=0; i--)
+        sum+=G.f[i];
+    return sum+1;
+}
+
+
+int check_in_sequence(const fGraph &G,const HybridOptions &options,FILE *out)
+    // The Nullstellensatz first, and then the exhaustive search if it is inconclusive.
+{
+    int val=is_fchoosable_nullstellensatz(G,options.check,out);
+    if ((val==0) || (val==1))
+    {
+        fprintf(out,"  Decided by the Nullstellensatz engine.\n");
+        return val;
+    }
+    if (val==2)
+        fprintf(out,"  The Nullstellensatz was inconclusive.\n");
+    
+    val=is_fchoosable_exhaustive(G,-1,-1,never_split(G),options.search,out);
+    fprintf(out,"  Decided by the exhaustive engine.\n");
+    return val;
+}
+
+
+int check_in_race(const fGraph &G,const HybridOptions &options,FILE *out)
+    // The Nullstellensatz runs on its own thread, and the exhaustive search on this one.
+    // Each writes to its own buffer, and only the buffer of the engine that decides the graph is written to out.
+{
+    std::atomic<int> decider(DECIDED_BY_NONE);
+    std::atomic<bool> stop_nullstellensatz(false), stop_exhaustive(false);
+    CheckOptions check_options=options.check;
+    SearchOptions search_options=options.search;
+    check_options.cancel=&stop_nullstellensatz;
+    search_options.cancel=&stop_exhaustive;
+    
+    char *nullstellensatz_text=NULL, *exhaustive_text=NULL;
+    size_t nullstellensatz_size=0, exhaustive_size=0;
+    FILE *nullstellensatz_out=open_memstream(&nullstellensatz_text,&nullstellensatz_size);
+    FILE *exhaustive_out=open_memstream(&exhaustive_text,&exhaustive_size);
+    if ((nullstellensatz_out==NULL) || (exhaustive_out==NULL))
+    {
+        printf("Could not allocate the output buffers of the engines.\n");
+        exit(9);
+    }
+    
+    int nullstellensatz_val=2;
+    std::thread prover([&]()
+    {
+        nullstellensatz_val=is_fchoosable_nullstellensatz(G,check_options,nullstellensatz_out);
+        int none=DECIDED_BY_NONE;
+        if (((nullstellensatz_val==0) || (nullstellensatz_val==1)) && decider.compare_exchange_strong(none,DECIDED_BY_NULLSTELLENSATZ))
+            stop_exhaustive=true;
+    });
+    
+    // The exhaustive search always decides the graph, unless it was stopped because the Nullstellensatz already has.
+    int exhaustive_val=is_fchoosable_exhaustive(G,-1,-1,never_split(G),search_options,exhaustive_out);
+    int none=DECIDED_BY_NONE;
+    if (decider.compare_exchange_strong(none,DECIDED_BY_EXHAUSTIVE))
+        stop_nullstellensatz=true;
+    
+    prover.join();
+    fclose(nullstellensatz_out);
+    fclose(exhaustive_out);
+    
+    int val;
+    if (decider.load()==DECIDED_BY_NULLSTELLENSATZ)
+    {
+        fwrite(nullstellensatz_text,1,nullstellensatz_size,out);
+        fprintf(out,"  Decided by the Nullstellensatz engine.\n");
+        val=nullstellensatz_val;
+    }
+    else
+    {
+        fwrite(exhaustive_text,1,exhaustive_size,out);
+        fprintf(out,"  Decided by the exhaustive engine.\n");
+        val=exhaustive_val;
+    }
+    free(nullstellensatz_text);
+    free(exhaustive_text);
+    
+    return val;
+}
+
+
+int check_graph(const char *line,size_t length,fGraph &G,const HybridOptions &options,FILE *out)
+    // We read the fgraph6 string of the given length at line into G, and test if it is f-choosable, reporting to out.
+    // A line that is not in fgraph6 format is reported and skipped, and 0 is returned, as it is not shown to be f-choosable.
+{
+    double start,end;  // for reporting CPU runtime
+    int val;
+    
+    start=cpu_seconds();  // record starting time
+    
+    if (!G.read_fgraph6(line,length))
+    {
+        fprintf(out,"Skipping a line that is not in fgraph6 format: %.*s\n\n",(int)length,line);
+        return 0;  // rather than checking a graph with an edge for each bad character
+    }
+    
+    fprintf(out,"Input read: n=%d %.*s\n",G.n,(int)length,line);
+    
+    bool raceable=options.race && (composition_total(G)>=0);
+    for (int i=G.n-1; i>=0; i--)
+        if (G.f[i]<=0)
+            raceable=false;  // the Nullstellensatz decides immediately
+    
+    if (raceable)
+        val=check_in_race(G,options,out);
+    else
+        val=check_in_sequence(G,options,out);
+    
+    end=cpu_seconds();
+    fprintf(out,"    CPU time used: %.3f seconds\n\n",end-start);
+    
+    return val;
+}
+
+
+int main(int argc, char *argv[])
+{
+    const char *line;
+    size_t length;
+    fGraph G;
+    int val=0;
+    int num_workers;
+    bool ordered;
+    HybridOptions options;
+    std::string engine_name;
+    int opt;  // for parsing the command line
+    
+    // defaults
+    num_workers=1;
+    ordered=true;
+    options.race=false;
+    options.check.num_threads=1;
+    engine_name="libexact";
+    options.check.cache_size=0;
+    options.check.max_compositions=0;
+    options.check.max_seconds=0;
+    options.check.cancel=NULL;
+    options.search.num_threads=1;
+    options.search.cache_size=0;
+    options.search.transposition_mb=0;
+    options.search.use_automorphisms=false;
+    options.search.use_hall_filter=false;
+    options.search.use_witness_pool=false;
+    options.search.checkpointer=NULL;
+    options.search.statistics_interval=60;
+    options.search.cancel=NULL;
+    options.search.totals=NULL;
+    options.search.progress_interval=0;
+    options.search.labels=NULL;
+    
+    // parse the command line
+    while ((opt=getopt(argc,argv,"p:ue:c:b:B:xf:T:aHW"))!=-1)  // the colons indicate the options take required arguments
+    {
+        switch (opt)
+        {
+            case 'p':
+                sscanf(optarg,"%d",&num_workers);
+                break;
+            case 'u':
+                ordered=false;
+                break;
+            case 'e':
+                engine_name=optarg;
+                break;
+            case 'c':
+                sscanf(optarg,"%d",&options.check.cache_size);
+                break;
+            case 'b':
+                sscanf(optarg,"%llu",&options.check.max_compositions);
+                break;
+            case 'B':
+                sscanf(optarg,"%lf",&options.check.max_seconds);
+                break;
+            case 'x':
+                options.race=true;
+                break;
+            case 'f':
+                sscanf(optarg,"%d",&options.search.cache_size);
+                break;
+            case 'T':
+                sscanf(optarg,"%d",&options.search.transposition_mb);
+                break;
+            case 'a':
+                options.search.use_automorphisms=true;
+                break;
+            case 'H':
+                options.search.use_hall_filter=true;
+                break;
+            case 'W':
+                options.search.use_witness_pool=true;
+                break;
+            case '?':
+                printf("Error parsing command line arguments; problem with option %c\n",optopt);
+                printf("USAGE: fchoosability_hybrid -p workers -u -e libexact|dp|modp|check|alontarsi -c entries -b compositions -B seconds -x\n");
+                printf("       -f cache_entries -T megabytes -a -H -W [input_file]\n");
+                printf("-c, -b, -B, and -x cannot be used with -e alontarsi.\n");
+                exit(8);
+            default:
+                ;
+        }
+    }
+    if (num_workers<1)
+    {
+        printf("-p requires at least 1 worker.\n");
+        exit(8);
+    }
+    if ((options.check.cache_size<0) || (options.search.cache_size<0))
+    {
+        printf("-c and -f require a nonnegative number of entries.\n");
+        exit(8);
+    }
+    if (options.check.max_seconds<0)
+    {
+        printf("-B requires a nonnegative number of seconds.\n");
+        exit(8);
+    }
+    if (options.search.transposition_mb<0)
+    {
+        printf("-T requires a nonnegative number of megabytes.\n");
+        exit(8);
+    }
+    if (engine_name=="libexact")
+        options.check.engine=ENGINE_LIBEXACT;
+    else if (engine_name=="dp")
+        options.check.engine=ENGINE_DP;
+    else if (engine_name=="modp")
+        options.check.engine=ENGINE_MODP;
+    else if (engine_name=="check")
+        options.check.engine=ENGINE_CHECK;
+    else if (engine_name=="alontarsi")
+        options.check.engine=ENGINE_ALONTARSI;
+    else
+    {
+        printf("-e must be libexact, dp, modp, check, or alontarsi.\n");
+        exit(8);
+    }
+    if ((options.check.engine==ENGINE_ALONTARSI) &&
+        ((options.check.cache_size>0) || (options.check.max_compositions>0) || (options.check.max_seconds>0) || options.race))
+    {
+        printf("-c, -b, -B, and -x cannot be used with -e alontarsi.\n");
+        exit(8);
+    }
+    if (options.race)
+        printf("Racing the Nullstellensatz and the exhaustive search\n");
+    if ((options.check.max_compositions>0) || (options.check.max_seconds>0))
+        printf("Giving up on the compositions after %llu compositions or %.3f seconds (0 is no limit)\n",
+               options.check.max_compositions,options.check.max_seconds);
+    if (num_workers>1)
+        printf("Using %d workers, writing the results in %s order\n",num_workers,ordered ? "input" : "completion");
+    
+    // We read lines in from the input file given after the options, or from stdin (see graphinput.h).
+    // Each line should be in fgraph6 format.
+    // If a line starts with '>', then it is treated as a comment.
+    
+    GraphInput input((optind<argc) ? argv[optind] : NULL);
+    
+    if (num_workers>1)
+    {
+        std::vector<fGraph> worker_G(num_workers);  // each worker reuses its fGraph for the graphs that it checks
+        GraphPipeline pipeline(num_workers,ordered);
+        val=pipeline.run(input,stdout,
+            [&](int worker,const std::string &line,FILE *out)
+            {
+                return check_graph(line.data(),line.size(),worker_G[worker],options,out);
+            });
+    }
+    else
+        while (input.next_graph(line,length))  // skips comments and short lines
+            val=check_graph(line,length,G,options,stdout);
+    
+    return (val==1);  // return true if the graph is f-choosable
+}
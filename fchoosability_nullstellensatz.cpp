@@ -8,215 +8,172 @@
 #include <string>
 #include <stdio.h>  // for printf
 #include <ctime>  // for reporting runtime
+#include <vector>
+#include <getopt.h>  // to use getopt to parse the command line
 #include "fgraph.h"
-#include "compositions.h"
+#include "nullstellensatz.h"
+#include "graphinput.h"
+#include "pipeline.h"
 
-extern "C" 
-{
-    #include "exact.h"  // libexact is a C library, not C++
-}
+
+/* -p specifies a number of workers that check different graphs of the input at the same time (see pipeline.h).
+ * The output of each graph is written in the order of the input, or in the order the graphs are finished with -u.
+ *
+ * -t specifies a number of threads that share the compositions of a single graph (see is_fchoosable_with_threads in nullstellensatz.h).
+ * This is meant for graphs with many compositions, and cannot be combined with -p.
+ *
+ * -e chooses how the leading coefficient of the graph polynomial is computed:
+ *     libexact  enumerates the terms of the expansion as the solutions of an exact cover problem (the default);
+ *     dp        multiplies in the factors one edge at a time (see graphpolynomial.h), which is much faster on larger graphs;
+ *     modp      is dp modulo the prime 2^61-1, which can only miss a nonzero coefficient that is a multiple of the prime;
+ *     check     computes both libexact and dp, and stops with exit code 7 if they differ.
+ * -e alontarsi instead searches for an Alon-Tarsi orientation (see alontarsi.h), which gives the exponents directly,
+ * so the compositions are not used, and neither are -t and -c.
+ *
+ * -c sets the number of entries in a cache of leading coefficients (see composition_succeeds in nullstellensatz.h).
+ * The default of 0 disables the cache.  Each thread or worker has its own cache of this size, which is kept for the following graphs.
+ */
 
 
-int leading_coefficient(const fGraph& G)
-    // We assume that sum(G.f[i]-1)==G.num_edges, 
-    // and that G.f[i]>=2 for all i.
+int check_graph(const char *line,size_t length,fGraph &G,const CheckOptions &options,FILE *out)
+    // We read the fgraph6 string of the given length at line into G, and test if it is f-choosable, reporting to out.
+    // A line that is not in fgraph6 format is reported and skipped, and 0 is returned, as it is not shown to be f-choosable.
 {
-    // for libexact
-    exact_t *e;
-    int soln_size;
-    const int *soln;
+    double start,end;  // for reporting CPU runtime
+    int val;
     
-    int n,num_edges;
-    int coeff,sign;
-    //int count;
-    int i,j,k;
+    start=cpu_seconds();  // record starting time
     
-    n=G.n;
-    num_edges=G.get_number_of_edges();
-    
-    if ((n<=1) || (num_edges==0))
+    if (!G.read_fgraph6(line,length))
     {
-        printf("PROBLEM: n=%d num_edges=%d\n",n,num_edges);
-        exit(7);
+        fprintf(out,"Skipping a line that is not in fgraph6 format: %.*s\n\n",(int)length,line);
+        return 0;  // rather than checking a graph with an edge for each bad character
     }
     
-    // Initialize the exact cover library.
-    e=exact_alloc();
-    
-    // In the exact cover problem, we have 2 columns for each edge (whether x_i or -x_j is chosen from the factor corresponding to the edge v_i v_j).
-    for (j=0; j<2*num_edges; j++)
-        exact_declare_col(e,j,1);
-    
-    // We also have n+e rows:
-    // The first n rows are the computation of the degree of the monomial.
-    for (i=0; i<n; i++)
-        exact_declare_row(e,i,G.f[i]-1);
+    fprintf(out,"Input read: n=%d %.*s\n",G.n,(int)length,line);
     
-    // The last e edges are ensuring exactly 1 term is chosen from each factor.
-    for ( ; i<n+num_edges; i++)
-        exact_declare_row(e,i,1);
-    
-    // Loop over the edges of G to set the matrix.
-    k=0;  // index of this edge
-    for (j=0; j<n; j++)
-        for (i=0; i<j; i++)
-            if (G.get_adj_sorted(i,j))  // i,j is an edge
-            {
-                // mark the contributions to x_i and x_j
-                exact_declare_entry(e,i,2*k);
-                exact_declare_entry(e,j,2*k+1);
-                
-                // ensure that exactly one term is chosen from each factor
-                exact_declare_entry(e,n+k,2*k);
-                exact_declare_entry(e,n+k,2*k+1);
-                k++;
-            }
-    
-    //count=0;
-    coeff=0;
-    while ((soln=exact_solve(e,&soln_size)) !=NULL)
-    {
-        sign=0;  // (-1)^sign is the contribution we will add to coeff
-        for (i=soln_size-1; i>=0; i--)
-            sign^=(soln[i]&1);  // the odd-indexed cols have negative sign; we want the parity of those
-                // sign is thus 0 or 1 at all times
-        coeff+=(1-2*sign);
-        //count+=1;
-    }
-    //printf("count=%d\n",count);
-    if (coeff!=0)
-        printf("  coeff=%2d  <---------\n",coeff);
+    val=is_fchoosable_nullstellensatz(G,options,out);
+    if (val==2)
+        fprintf(out,"  The Nullstellensatz was inconclusive.\n");
     
-    exact_free(e);
+    end=cpu_seconds();
+    fprintf(out,"    CPU time used: %.3f seconds\n\n",end-start);
     
-    return coeff;
+    return val;
 }
 
 
-int is_fchoosable(const fGraph& G)
-    // We test if an fgraph is f-choosable.
-    // A returned value of 1 means that we can prove using the Combinatorial Nullstellensatz that G is f-choosable.
-    // Other returned values means that such a proof fails.
+int main(int argc, char *argv[])
 {
-    int sum_f_minus_1,diff;
-    int i;
-    int condition_of_H;  // return value of H->remove_vertices_with_f_1()
-    fGraph H;
-    Compositions C;
-    
-    
-    for (i=G.n-1; i>=0; i--)
-        if (G.f[i]<=0)
+    const char *line;
+    size_t length;
+    fGraph G;
+    int val=0;
+    int num_workers;
+    bool ordered;
+    CheckOptions options;
+    std::string engine_name;
+    int opt;  // for parsing the command line
+    
+    // defaults
+    num_workers=1;
+    ordered=true;
+    options.num_threads=1;
+    engine_name="libexact";
+    options.cache_size=0;
+    options.max_compositions=0;  // the whole search, as there is no other engine to fall back on
+    options.max_seconds=0;
+    options.cancel=NULL;
+    
+    // parse the command line
+    while ((opt=getopt(argc,argv,"p:ut:e:c:"))!=-1)  // the colons indicate the options take required arguments
+    {
+        switch (opt)
         {
-            printf("f[%d]=%d<=0, which means the graph is not f-choosable.\n",i,G.f[i]);
-            return 0;
+            case 'p':
+                sscanf(optarg,"%d",&num_workers);
+                break;
+            case 'u':
+                ordered=false;
+                break;
+            case 't':
+                sscanf(optarg,"%d",&options.num_threads);
+                break;
+            case 'e':
+                engine_name=optarg;
+                break;
+            case 'c':
+                sscanf(optarg,"%d",&options.cache_size);
+                break;
+            case '?':
+                printf("Error parsing command line arguments; problem with option %c\n",optopt);
+                printf("USAGE: fchoosability_nullstellensatz -p workers -u -t threads -e libexact|dp|modp|check|alontarsi -c entries [input_file]\n");
+                printf("-p cannot be used with -t.\n");
+                exit(8);
+            default:
+                ;
         }
-    
-    sum_f_minus_1=0;
-    for (i=G.n-1; i>=0; i--)
-        sum_f_minus_1+=(G.f[i]-1);
-    diff=sum_f_minus_1-G.get_number_of_edges();
-    
-    //printf("diff=%d\n",diff);
-    
-    if (diff<0)
+    }
+    if (num_workers<1)
     {
-        printf("sum(f[i]-1)<num_edges, so the Nullstellensatz cannot be used.\n");
-        return 3;
+        printf("-p requires at least 1 worker.\n");
+        exit(8);
     }
-    else if (diff==0)
+    if (options.num_threads<1)
     {
-        H.copy_from(G);
-        condition_of_H=H.remove_vertices_with_f_1();
-        if (   (condition_of_H==2) || 
-             ( (condition_of_H==1) && (leading_coefficient(H)!=0) )
-           )
-                    // f[i]>=2 for all i, so we can call leading_coefficient
-        {
-            printf("Success! <===============================================================================\n");
-            printf("  f(G)=");
-            for (i=0; i<G.n-1; i++)
-                printf("%d,",G.f[i]);
-            printf("%d\n",G.f[G.n-1]);
-            
-            return 1;  // G is proved to be f-choosable by the Combin Nullst.
-        }
-        else
-            return 2;  // the Combin Nullst is inconclusive
+        printf("-t requires at least 1 thread.\n");
+        exit(8);
     }
-    // else if (diff>0)
-    
-    C.first(diff,G.n);  // initialize the compositions; we know that diff>0
-    do  // iterate over all compositions
+    if (options.cache_size<0)
     {
-        /*
-        printf("C->x: ");
-        for (i=0; i<G.n; i++)
-           printf("%d ",C->x[i]);
-        printf("\n");
-        //*/
-        
-        // reset the adjacencies in H, in case they were changed when removing vertices with f[i]==1
-        H.copy_from(G);
-        
-        // set H's f vector to be G's f vector minus the composition
-        for (i=G.n-1; i>=0; i--)
-            H.f[i]= G.f[i] - C.x[i];
-        
-        condition_of_H=H.remove_vertices_with_f_1();
-        if (   (condition_of_H==2) || 
-             ( (condition_of_H==1) && (leading_coefficient(H)!=0) )
-           )
-                    // f[i]>=2 for all i, so we can call leading_coefficient
-        {
-            printf("Success! <===============================================================================\n");
-            printf("  f(H)=");
-            for (i=0; i<G.n; i++)
-                printf("%d,",G.f[i]-C.x[i]);  // H.f[i] might have been modified when removing vertices with f[i]==1
-            printf("%d\n",G.f[G.n-1]-C.x[G.n-1]);
-            
-            return 1;  // G is proved to be f-choosable by the Combin Nullst.
-        }
-        
-    } while (C.next());
-    
-    return 2;  // the Combin Nullst is inconclusive
-}
-
-
-
-int main()
-{
-    std::string line_in;
-    fGraph G;
-    int val=0;
-    clock_t start,end;  // for reporting CPU runtime
+        printf("-c requires a nonnegative number of entries.\n");
+        exit(8);
+    }
+    if ((num_workers>1) && (options.num_threads>1))
+    {
+        printf("-p cannot be used with -t.\n");
+        exit(8);
+    }
+    if (engine_name=="libexact")
+        options.engine=ENGINE_LIBEXACT;
+    else if (engine_name=="dp")
+        options.engine=ENGINE_DP;
+    else if (engine_name=="modp")
+        options.engine=ENGINE_MODP;
+    else if (engine_name=="check")
+        options.engine=ENGINE_CHECK;
+    else if (engine_name=="alontarsi")
+        options.engine=ENGINE_ALONTARSI;
+    else
+    {
+        printf("-e must be libexact, dp, modp, check, or alontarsi.\n");
+        exit(8);
+    }
+    if ((options.engine==ENGINE_ALONTARSI) && ((options.num_threads>1) || (options.cache_size>0)))
+    {
+        printf("-t and -c cannot be used with -e alontarsi.\n");
+        exit(8);
+    }
     
-    // We read lines in from stdin.
+    // We read lines in from the input file given after the options, or from stdin (see graphinput.h).
     // Each line should be in fgraph6 format.
     // If a line starts with '>', then it is treated as a comment.
     
-    while (std::getline(std::cin,line_in))
+    GraphInput input((optind<argc) ? argv[optind] : NULL);
+    
+    if (num_workers>1)
     {
-        if (line_in.length()<=3)  // this line is too short, probably end of file
-            continue;
-        
-        if (line_in[0]=='>')  // treat this line as a comment
-            continue;
-        
-        start=clock();  // record starting time
-        
-        G.read_fgraph6_string(line_in);
-        
-        printf("Input read: n=%d %s\n",G.n,line_in.c_str());
-        
-        val=is_fchoosable(G);
-        if (val==2)
-            printf("  The Nullstellensatz was inconclusive.\n");
-        
-        end=clock();
-        printf("    CPU time used: %.3f seconds\n\n",((double)(end-start))/CLOCKS_PER_SEC);
+        std::vector<fGraph> worker_G(num_workers);  // each worker reuses its fGraph for the graphs that it checks
+        GraphPipeline pipeline(num_workers,ordered);
+        val=pipeline.run(input,stdout,
+            [&](int worker,const std::string &line,FILE *out)
+            {
+                return check_graph(line.data(),line.size(),worker_G[worker],options,out);
+            });
     }
+    else
+        while (input.next_graph(line,length))  // skips comments and short lines
+            val=check_graph(line,length,G,options,stdout);
     
     return (val==1);  // return true if the graph can be proven f-choosable
 }
@@ -0,0 +1,232 @@
+
+// feasibilitycache.h
+// This is a C++ library for remembering which multisets of colorability classes have a feasible coloring.
+// The library is contained in one header file to enable use of inline functions.
+
+// Copyright 2017, Stephen G. Hartke
+// Licensed under the GPL version 3.
+
+
+#pragma once  // for compilers that support this
+#ifndef FEASIBILITYCACHE_H__AEKOHCHAIPHEEZOOTHEI  // include guard
+#define FEASIBILITYCACHE_H__AEKOHCHAIPHEEZOOTHEI
+
+
+#include <vector>
+#include <algorithm>  // for sort
+#include "bitarray.h"
+#include "colorabilityclass.h"
+
+
+/* Whether a partial list assignment has a feasible coloring depends only on the multiset of its colorability classes,
+ * and the same multiset can be reached with different orders and multiplicities of the classes.
+ * The key of the classes 0..cur_color is the sorted classes, and its hash is the sum of the hashes of the classes,
+ * which does not depend on their order.
+ *
+ * A check is usually cheap, so the cache must be cheaper still.  has_feasible_coloring is called for each class generated on a level,
+ * with the same classes below it, so the sorted classes below each level and the sum of their hashes are kept,
+ * and are recomputed when the undo_frame of the level changes, since each setup of a level has a new frame (see subgraph.h).
+ * They are usually extended from the level below by inserting its class.  Then a lookup is a single hash and a comparison of the
+ * entry in its slot, and there is no allocation.  The table is direct mapped, so a new entry replaces the entry in its slot,
+ * and each entry has room for all of the levels.
+ *
+ * The hits are mostly of multisets that were checked recently, so a small cache gets most of them.  It saves time when the checks
+ * are expensive, which is for graphs with more vertices, and when many classes repeat, such as for sparse graphs with f at least 3;
+ * otherwise the lookups cost more than the checks they save, so the cache is off by default.
+ */
+
+
+template <typename bitarray_t>
+////////////////////////////////////////////////////////////////////////////////////////
+class FeasibilityCache
+////////////////////////////////////////////////////////////////////////////////////////
+{
+public:
+    size_t max_entries;  // 0 disables the cache; resize sets it, and clear resets it
+    unsigned long long int hits, misses, evictions;
+    
+    FeasibilityCache();
+    
+    void resize(size_t max_entries,int num_levels);
+    void clear();
+    bool enabled() const;
+    bool lookup(const std::vector<ColorabilityClassInfo<bitarray_t> > &color_info,int cur_color,bool &result);
+    void insert(const std::vector<ColorabilityClassInfo<bitarray_t> > &color_info,int cur_color,bool result);
+
+private:
+    int num_levels;
+    
+    // These are indexed by level, for the classes below the level.
+    std::vector<unsigned long long int> frame;  // the undo_frame of the level when its classes were sorted; 0 if they have not been
+    std::vector<uint64_t> below_hash;
+    std::vector<bitarray_t> below_sorted;  // indexed by level*num_levels+i
+    
+    // These are indexed by slot.
+    std::vector<uint64_t> entry_hash;
+    std::vector<int> entry_size;  // the number of classes of the entry; 0 if the slot is empty
+    std::vector<char> entry_result;
+    std::vector<bitarray_t> entry_classes;  // indexed by slot*num_levels+i; sorted
+    
+    uint64_t lookup_hash;  // of the classes of the last lookup, which insert uses
+    size_t lookup_slot;
+    
+    void sort_level(const std::vector<ColorabilityClassInfo<bitarray_t> > &color_info,int level);
+    bool matches(size_t slot,int level,const bitarray_t &colorability_class) const;
+};
+
+
+template <typename bitarray_t>
+FeasibilityCache<bitarray_t>::FeasibilityCache()
+  : // initializer list
+    max_entries(0),
+    hits(0),
+    misses(0),
+    evictions(0),
+    num_levels(0),
+    lookup_hash(0),
+    lookup_slot(0)
+{
+}
+
+
+template <typename bitarray_t>
+void FeasibilityCache<bitarray_t>::resize(size_t max_entries,int num_levels)
+    // Forgets the entries, which belong to the previous graph.
+{
+    this->max_entries=max_entries;
+    this->num_levels=num_levels;
+    
+    frame.assign(num_levels,0);
+    below_hash.resize(num_levels);
+    below_sorted.resize(num_levels*num_levels);
+    
+    entry_hash.resize(max_entries);
+    entry_size.assign(max_entries,0);
+    entry_result.resize(max_entries);
+    entry_classes.resize(max_entries*num_levels);
+    
+    hits=0;
+    misses=0;
+    evictions=0;
+}
+
+
+template <typename bitarray_t>
+void FeasibilityCache<bitarray_t>::clear()
+{
+    max_entries=0;
+    hits=0;
+    misses=0;
+    evictions=0;
+}
+
+
+template <typename bitarray_t>
+inline
+bool FeasibilityCache<bitarray_t>::enabled() const
+{
+    return max_entries>0;
+}
+
+
+template <typename bitarray_t>
+void FeasibilityCache<bitarray_t>::sort_level(const std::vector<ColorabilityClassInfo<bitarray_t> > &color_info,int level)
+{
+    frame[level]=color_info[level].undo_frame;
+    bitarray_t *sorted=&below_sorted[level*num_levels];
+    
+    if ((level>0) && (frame[level-1]==color_info[level-1].undo_frame))
+    {
+        // The level below is sorted, so its class is inserted.
+        const bitarray_t &added=color_info[level-1].colorability_class;
+        const bitarray_t *sorted_below=&below_sorted[(level-1)*num_levels];
+        int i=level-1;
+        for ( ; (i>0) && (added<sorted_below[i-1]); i--)
+            sorted[i]=sorted_below[i-1];
+        sorted[i]=added;
+        for (i--; i>=0; i--)
+            sorted[i]=sorted_below[i];
+        below_hash[level]=below_hash[level-1]+hash_bits(added);
+        return;
+    }
+    
+    below_hash[level]=0;
+    for (int c=level-1; c>=0; c--)
+    {
+        sorted[c]=color_info[c].colorability_class;
+        below_hash[level]+=hash_bits(sorted[c]);
+    }
+    std::sort(sorted,sorted+level);
+}
+
+
+template <typename bitarray_t>
+inline
+bool FeasibilityCache<bitarray_t>::matches(size_t slot,int level,const bitarray_t &colorability_class) const
+    // Returns true if the entry in slot is the classes below level together with colorability_class.
+{
+    if (entry_size[slot]!=level+1)
+        return false;
+    
+    const bitarray_t *entry=&entry_classes[slot*num_levels];
+    const bitarray_t *sorted=&below_sorted[level*num_levels];
+    int i=0, j=0;
+    for ( ; (j<level) && (sorted[j]<colorability_class); i++, j++)
+        if (entry[i]!=sorted[j])
+            return false;
+    if (entry[i]!=colorability_class)
+        return false;
+    for (i++; j<level; i++, j++)
+        if (entry[i]!=sorted[j])
+            return false;
+    return true;
+}
+
+
+template <typename bitarray_t>
+inline
+bool FeasibilityCache<bitarray_t>::lookup(const std::vector<ColorabilityClassInfo<bitarray_t> > &color_info,int cur_color,bool &result)
+    // Returns true if the classes 0..cur_color are in the cache, and then sets result to whether they have a feasible coloring.
+{
+    if (frame[cur_color]!=color_info[cur_color].undo_frame)
+        sort_level(color_info,cur_color);
+    
+    const bitarray_t &colorability_class=color_info[cur_color].colorability_class;
+    lookup_hash=below_hash[cur_color]+hash_bits(colorability_class);
+    lookup_slot=lookup_hash%max_entries;
+    if ((entry_hash[lookup_slot]==lookup_hash) && matches(lookup_slot,cur_color,colorability_class))
+    {
+        hits++;
+        result=entry_result[lookup_slot];
+        return true;
+    }
+    misses++;
+    return false;
+}
+
+
+template <typename bitarray_t>
+inline
+void FeasibilityCache<bitarray_t>::insert(const std::vector<ColorabilityClassInfo<bitarray_t> > &color_info,int cur_color,bool result)
+    // Records result for the classes 0..cur_color, which must be the classes of the last lookup.
+{
+    size_t slot=lookup_slot;
+    if (entry_size[slot]>0)
+        evictions++;
+    entry_hash[slot]=lookup_hash;
+    entry_size[slot]=cur_color+1;
+    entry_result[slot]=result;
+    
+    const bitarray_t &colorability_class=color_info[cur_color].colorability_class;
+    bitarray_t *entry=&entry_classes[slot*num_levels];
+    const bitarray_t *sorted=&below_sorted[cur_color*num_levels];
+    int i=0, j=0;
+    for ( ; (j<cur_color) && (sorted[j]<colorability_class); i++, j++)
+        entry[i]=sorted[j];
+    entry[i]=colorability_class;
+    for (i++; j<cur_color; i++, j++)
+        entry[i]=sorted[j];
+}
+
+
+#endif  // FEASIBILITYCACHE_H__AEKOHCHAIPHEEZOOTHEI
@@ -16,6 +16,7 @@
 #include <vector>
 #include <string>
 #include "graph.h"
+#include "bitarray.h"  // for popcount, lowest_bit, and highest_bit
 
 /////////////////////////////////////////////////////////////////////////////
 // Helper functions for "radix64" representation.
@@ -49,7 +50,7 @@ char encode_6bits(int x)
 inline
 int decode_6bits(char x)
 {
-    return inverse_mapping[(size_t)x];  // cast char x to be appropriate for indexing
+    return inverse_mapping[(unsigned char)x];  // cast char x to be appropriate for indexing
 }
 
 
@@ -71,9 +72,13 @@ public:
     
     void allocate(int n);
     void copy_from(const fGraph& H);
+    void relabel_from(const fGraph& H,const std::vector<int> &order);
     
     void read_fgraph6_string(const std::string &fgraph6);
+    bool read_fgraph6(const char *fgraph6,size_t length);
+    std::string write_fgraph6_string() const;
     int remove_vertices_with_f_1();
+    int copy_with_vertices_with_f_1_removed(const fGraph &G,const std::vector<int> &x);
 };
 
 
@@ -87,17 +92,7 @@ fGraph::fGraph()
 fGraph::fGraph(const fGraph& G) 
        :UndirectedGraph()  // call the base constructor
 {
-    int i;
-    
-    allocate(G.n);  // allocate the data structures
-    
-    // We need to copy the adjacencies from G to the new graph.
-    for (i=nchoose2-1; i>=0; i--)  // counting down is faster because the condition is testing against 0
-        adj[i]=G.adj[i];
-    
-    // We need to copy the f vector from G to the new graph.
-    for (i=n-1; i>=0; i--)
-        f[i]=G.f[i];
+    copy_from(G);
 }
 
 
@@ -121,9 +116,14 @@ void fGraph::copy_from(const fGraph& H)
     
     allocate(H.n);
     
-    // copy the adj matrix
+    // copy the adj matrix, and its rows
     for (i=nchoose2-1; i>=0; i--)
         adj[i]=H.adj[i];
+    for (i=n*words_per_row-1; i>=0; i--)
+        rows[i]=H.rows[i];
+    for (i=n-1; i>=0; i--)
+        degree[i]=H.degree[i];
+    num_edges=H.num_edges;
     
     // copy the f vector
     for (i=n-1; i>=0; i--)
@@ -131,45 +131,114 @@ void fGraph::copy_from(const fGraph& H)
 }
 
 
+void fGraph::relabel_from(const fGraph& H,const std::vector<int> &order)
+    // Copies H with its vertices relabeled, so that vertex i is vertex order[i] of H (see ordering.h).
+    // H cannot be this fgraph.
+{
+    int i,j;
+    
+    allocate(H.n);  // this also zeroes the adjacencies
+    
+    for (j=n-1; j>=0; j--)
+        for (i=j-1; i>=0; i--)
+            if (H.get_adj(order[i],order[j]))
+                set_adj_sorted(i,j,H.get_adj(order[i],order[j]));
+    
+    for (i=n-1; i>=0; i--)
+        f[i]=H.f[order[i]];
+}
+
+
 void fGraph::read_fgraph6_string(const std::string &fgraph6)
     // Reads in fgraph6 format
 {
-    int cur;  // the index of the current character in the string that we're considering
+    read_fgraph6(fgraph6.data(),fgraph6.size());
+}
+
+
+bool fGraph::read_fgraph6(const char *fgraph6,size_t length)
+    // Reads in fgraph6 format from the length characters at fgraph6, which need not be zero terminated,
+    // such as a line from GraphInput.
+    // Returns false if a character is not in the radix64 mapping, or if there are no vertices or too few values of f,
+    // and then the graph is not valid.
+{
+    size_t cur;  // the index of the current character in the string that we're considering
     int gn;  // the number of vertices in the graph in fgraph6
-    int val,mask;
-    int i,j;
+    int i;
     
-    cur=0;
-    gn=decode_6bits(fgraph6[cur]);
+    // The number of vertices is given in radix64 by the characters before the first underscore, most significant first.
+    // Graphs with at most 63 vertices thus use a single character.
+    gn=0;
+    for (cur=0; (cur<length) && (fgraph6[cur]!='_'); cur++)
+    {
+        if (decode_6bits(fgraph6[cur])<0)
+            return false;
+        gn=(gn<<6)+decode_6bits(fgraph6[cur]);
+    }
+    if ((gn<1) || (cur+1+gn>length))
+        return false;  // such as a fragment of a line
     
-    allocate(gn);  // this also sets this->n to gn, as well as allocates f
+    allocate(gn);  // this also sets this->n to gn, as well as allocates f and zeroes the adjacencies
     
-    cur+=2;  // advance past the underscore
+    cur++;  // advance past the underscore
     
     // read in the f-vector
-    for (i=0; i<n; i++)
+    for (i=0; (i<n) && (cur<length); i++)
     {
         f[i]=decode_6bits(fgraph6[cur]);
+        if (f[i]<0)
+            return false;
         cur++;
     }
     
     cur++;  // advance past the underscore
     
-    // read in the adjacency matrix
-    val=decode_6bits(fgraph6[cur]);
+    // read in the adjacency matrix, which is bit packed in colex order in fgraph6 format
+    if (cur<length)
+        return read_packed_adjacencies(fgraph6+cur,fgraph6+length,inverse_mapping);
+    return true;
+}
+
+
+std::string fGraph::write_fgraph6_string() const
+    // Writes in fgraph6 format, as read by read_fgraph6_string.
+    // The f values must be at most 63.
+{
+    std::string fgraph6;
+    int val,mask;
+    int i,j;
+    
+    // the number of vertices in radix64, most significant first
+    int num_digits=1;
+    while ((n>>(6*num_digits))>0)
+        num_digits++;
+    for (i=num_digits-1; i>=0; i--)
+        fgraph6+=encode_6bits((n>>(6*i))&63);
+    fgraph6+='_';
+    
+    for (i=0; i<n; i++)
+        fgraph6+=encode_6bits(f[i]);
+    fgraph6+='_';
+    
+    val=0;
     mask=1<<5;  // start with the high bit
     for (j=0; j<n; j++)  // adj matrix is bit packed in colex order in fgraph6 format
         for (i=0; i<j; i++)
         {
-            set_adj_sorted(i,j,(val&mask)!=0);  // test whether that bit is nonzero
+            if (get_adj_sorted(i,j))
+                val|=mask;
             mask>>=1;
             if (!mask)  // mask has become 0
             {
-                cur++;
-                val=decode_6bits(fgraph6[cur]);
+                fgraph6+=encode_6bits(val);
+                val=0;
                 mask=1<<5;
             }
         }
+    if (mask!=(1<<5))  // the last bits are a partial group
+        fgraph6+=encode_6bits(val);
+    
+    return fgraph6;
 }
 
 
@@ -269,7 +338,10 @@ int fGraph::remove_vertices_with_f_1()
                 // we swap vertices j and n-1
                 for (i=n-2; i>=0; i--)
                     if (i!=j)
+                    {
                         set_adj(j,i,get_adj(n-1,i));
+                        set_adj(n-1,i,0);  // so that the rows and degrees only count the remaining vertices
+                    }
                 
                 f[j]=f[n-1];
                 f[n-1]=0;
@@ -296,4 +368,74 @@ int fGraph::remove_vertices_with_f_1()
 }
 
 
+int fGraph::copy_with_vertices_with_f_1_removed(const fGraph &G,const std::vector<int> &x)
+    // This is the same as copying G, subtracting x from the f vector, and calling remove_vertices_with_f_1(), and returns the same values,
+    // but is much faster when called for many x.
+    // G must have at most 64 vertices, so that each row is one word.
+    //
+    // The removed vertices are tracked in a bitarray, and the vertices with f[i]==1 are kept in a worklist,
+    // so only the neighbors of the removed vertices are visited.
+    // G is not modified, and the remaining vertices are relabeled while copying the adjacencies into this graph,
+    // using the same relabeling that remove_vertices_with_f_1() would give.
+    // The work space is on the stack, and this graph's vectors are only resized, so once they are large enough there is no allocation.
+{
+    int new_f[64];
+    int worklist[64];
+    int old_label[64];  // the vertex of G that becomes vertex i of this graph
+    int num_worklist=0;
+    int i,j,v;
+    uint64_t remaining=0;  // the vertices that have not been removed
+    
+    for (i=G.n-1; i>=0; i--)
+    {
+        new_f[i]=G.f[i]-x[i];
+        if (new_f[i]<=0)
+            return 0;
+        if (new_f[i]==1)
+            worklist[num_worklist++]=i;
+        remaining|=uint64_t(1)<<i;
+    }
+    
+    while (num_worklist>0)
+    {
+        v=worklist[--num_worklist];
+        remaining&=~(uint64_t(1)<<v);
+        for (uint64_t neighbors=G.get_row(v)[0] & remaining; neighbors; neighbors&=neighbors-1)
+        {
+            j=lowest_bit(neighbors);
+            new_f[j]--;
+            if (new_f[j]==0)
+                return 0;
+            if (new_f[j]==1)
+                worklist[num_worklist++]=j;
+        }
+    }
+    
+    int new_n=popcount(remaining);
+    if (new_n<=1)  // all but at most one of the vertices successfully removed in a greedy fashion
+        return 2;
+    
+    // The last remaining vertex fills the first gap, as in remove_vertices_with_f_1().
+    uint64_t unlabeled=remaining;
+    for (i=0; i<new_n; i++)
+    {
+        v=(unlabeled & (uint64_t(1)<<i)) ? i : highest_bit(unlabeled);
+        old_label[i]=v;
+        unlabeled&=~(uint64_t(1)<<v);
+    }
+    
+    allocate(new_n);  // this zeroes the adjacencies
+    for (j=0; j<new_n; j++)
+    {
+        uint64_t row=G.get_row(old_label[j])[0];
+        for (i=0; i<j; i++)
+            if ((row>>old_label[i]) & 1)
+                set_adj_sorted(i,j,1);
+        f[j]=new_f[old_label[j]];
+    }
+    
+    return 1;  // this graph is now ready to be checked with the Nullstellensatz
+}
+
+
 #endif  // FGRAPH_H__IECHAIFEUS
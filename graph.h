@@ -13,6 +13,9 @@
 
 
 #include <vector>
+#include <utility>  // for pair
+#include <cstdint>
+#include <cstring>  // for strlen
 
 
 /////////////////////////////////////////////////////////////////////////////
@@ -60,6 +63,27 @@ int pair_sorted_to_index(int i, int j)
 }
 
 
+struct Graph6Decoding
+    // The 6 bits of each character of graph6 format, as a table so that it can be used like inverse_mapping for fgraph6.
+{
+    int table[256];
+    
+    Graph6Decoding()
+    {
+        for (int c=0; c<256; c++)
+            table[c]=((c>=63) && (c<=126)) ? c-63 : -1;
+    }
+};
+
+
+inline
+const int* graph6_decoding()
+{
+    static const Graph6Decoding decoding;
+    return decoding.table;
+}
+
+
 inline
 void index_to_pair(int index, int *i, int *j)
 {
@@ -83,6 +107,14 @@ public:
     int nchoose2;  // binomial(n,2)
     std::vector<int> adj;  // the adjacency matrix
             // The adacency matrix is stored as a one-dimensional array of integers of length binomial(data_structure_size,2), sorted in colex order.
+    
+    // The same adjacencies are also kept as rows of bits, which are what the searches use.
+    // Bit j of row i is set if adj(i,j) is nonzero, and the row is stored in words_per_row words, low order word first.
+    // The rows, degrees, and number of edges are kept up to date by set_adj and set_adj_sorted.
+    int words_per_row;
+    std::vector<uint64_t> rows;
+    std::vector<int> degree;  // the number of nonzero entries in the row
+    int num_edges;  // the number of nonzero entries in the adjacency matrix
 
     UndirectedGraph();  // create an unallocated graph, n=-1
     UndirectedGraph(int n);  // create an empty graph with n vertices
@@ -94,6 +126,7 @@ public:
 
     void zero_adj();
     void read_graph6_string(char *g6);
+    bool read_packed_adjacencies(const char *cur, const char *end, const int *decode);
     void write_graph6_string(char *g6, int length) const;
     void print_adj_matrix() const;
     
@@ -103,12 +136,20 @@ public:
     int get_adj_sorted(int i, int j) const;
     
     int get_number_of_edges() const;
+    const uint64_t* get_row(int i) const;
+    void get_edges(std::vector<std::pair<int,int> > &edges) const;
+
+private:
+    void update_row_bits(int i, int j, int old_val, int val);
 };
 
 
 UndirectedGraph::UndirectedGraph()  // create an unallocated graph, n=-1
 {
     n=-1;
+    nchoose2=0;
+    words_per_row=0;
+    num_edges=0;
 }
 
 
@@ -130,16 +171,25 @@ UndirectedGraph::UndirectedGraph(UndirectedGraph *G, int k)  // create an induce
     
     // We need to copy the adjacencies from G to the new graph.
     // By the magic of colex order, this is the first nchoose2 elements of the adj matrix.
-    for (int index=nchoose2-1; index>=0; index--)  // counting down is faster because the condition is testing against 0
-        adj[index]=G->adj[index];
+    // We go through set_adj_sorted so that the rows are also set.
+    for (int j=1; j<k; j++)
+        for (int i=0; i<j; i++)
+            if (G->get_adj_sorted(i,j))
+                set_adj_sorted(i,j,G->get_adj_sorted(i,j));
 }
 
 
 void UndirectedGraph::allocate(int n)
+    // This also zeroes the adjacencies.
+    // The vectors are only resized, so reusing a graph for graphs that are no larger does not allocate memory.
 {
     this->n=n;
     nchoose2=binomial2(n);
+    words_per_row=(n+63)/64;
     adj.resize(nchoose2);  // resize the adjacency matrix if necessary
+    rows.resize(n*words_per_row);
+    degree.resize(n);
+    zero_adj();
 }
 
 
@@ -149,6 +199,11 @@ void UndirectedGraph::zero_adj()
     int index;
     for (index=nchoose2-1; index>=0; index--)  // counting down is faster because the condition is testing against 0
         adj[index]=0;
+    for (index=n*words_per_row-1; index>=0; index--)
+        rows[index]=0;
+    for (index=n-1; index>=0; index--)
+        degree[index]=0;
+    num_edges=0;
 }
 
 
@@ -158,8 +213,7 @@ void UndirectedGraph::read_graph6_string(char *g6)
 {
     char *cur;  // the current character in the string that we're considering
     int gn;  // the number of vertices in the graph in g6
-    int val,mask;
-    int i,j;
+    int i;
     
     cur=g6;
     if (*cur==126)  // the graph has at least 63 vertices
@@ -191,23 +245,51 @@ void UndirectedGraph::read_graph6_string(char *g6)
         gn=*cur-63;
     cur++;  // move past the information on the number of vertices
     
-    allocate(gn);  // this also sets this->n to gn
+    allocate(gn);  // this also sets this->n to gn, and zeroes the adjacencies
     
-    // read in the adjacency matrix
-    val=*cur-63;
-    mask=1<<5;  // start with the high bit
-    for (j=0; j<gn; j++)  // adj matrix is bit packed in colex order in graph6 format
-        for (i=0; i<j; i++)
+    read_packed_adjacencies(cur,cur+strlen(cur),graph6_decoding());
+}
+
+
+bool UndirectedGraph::read_packed_adjacencies(const char *cur, const char *end, const int *decode)
+    // Sets the adjacencies from the characters from cur to end, which hold 6 bits each, high bit first, in colex order,
+    // as in graph6 and fgraph6 formats.  decode gives the 6 bits of each character, or -1 if it is not valid.
+    // Returns false at the first character that is not valid, and then the adjacencies are incomplete.
+    // The graph must have just been allocated, so that only the edges need to be set.
+    // We decode 4 characters into a 24 bit word at a time, and only visit the bits that are set,
+    // so the time is proportional to the length of the string plus the number of edges.
+    // Missing characters at the end are treated as 0s.
+{
+    int j=1, base=0;  // the pair (i,j) has index base+i, where base=binomial2(j)
+    long available=end-cur;
+    
+    for (int first=0, c=0; first<nchoose2; first+=24, c+=4)  // first is the index of the pair of the high bit of the word
+    {
+        uint32_t word=0;
+        for (int k=c; k<c+4; k++)
         {
-            set_adj_sorted(i,j,(val&mask)!=0);  // test whether that bit is nonzero
-            mask>>=1;
-            if (!mask)  // mask has become 0
+            int bits=(k<available) ? decode[(unsigned char)cur[k]] : 0;
+            if (bits<0)
+                return false;
+            word=(word<<6) | bits;
+        }
+        
+        while (word)
+        {
+            int b=31-__builtin_clz(word);
+            word^=uint32_t(1)<<b;
+            int index=first+23-b;
+            if (index>=nchoose2)
+                break;  // the padding bits at the end
+            while (index>=base+j)
             {
-                cur++;
-                val=*cur-63;
-                mask=1<<5;
+                base+=j;
+                j++;
             }
+            set_adj_sorted(index-base,j,1);
         }
+    }
+    return true;
 }
 
 
@@ -335,17 +417,37 @@ void UndirectedGraph::print_adj_matrix() const
 /////////////////////////////////////////////////////////////////////////////
 
 
+inline
+void UndirectedGraph::update_row_bits(int i, int j, int old_val, int val)
+    // Keeps the rows, degrees, and number of edges up to date when adj(i,j) changes from old_val to val.
+{
+    if ((old_val!=0)==(val!=0))
+        return;
+    
+    int change=(val!=0) ? 1 : -1;
+    rows[i*words_per_row+(j>>6)]^=uint64_t(1)<<(j&63);
+    rows[j*words_per_row+(i>>6)]^=uint64_t(1)<<(i&63);
+    degree[i]+=change;
+    degree[j]+=change;
+    num_edges+=change;
+}
+
+
 inline
 void UndirectedGraph::set_adj(int i, int j, int val)
 {
-    adj[pair_to_index(i,j)]=val;
+    int index=pair_to_index(i,j);
+    update_row_bits(i,j,adj[index],val);
+    adj[index]=val;
 }
 
 
 inline
 void UndirectedGraph::set_adj_sorted(int i, int j, int val)
 {
-    adj[pair_sorted_to_index(i,j)]=val;
+    int index=pair_sorted_to_index(i,j);
+    update_row_bits(i,j,adj[index],val);
+    adj[index]=val;
 }
 
 
@@ -368,13 +470,38 @@ int UndirectedGraph::get_adj_sorted(int i, int j) const
 
 inline
 int UndirectedGraph::get_number_of_edges() const
+    // The number of nonzero entries of the adjacency matrix, which is kept up to date by set_adj.
 {
-    int e=0;
-    int i;
-    
-    for (i=binomial2(n)-1; i>=0; i--)
-        e+=adj[i];  // we just sum the entries of (the upper part of) the adjacency matrix
-    return e;
+    return num_edges;
+}
+
+
+inline
+const uint64_t* UndirectedGraph::get_row(int i) const
+    // The neighbors of i, as words_per_row words with the low order word first.
+{
+    return &rows[i*words_per_row];
+}
+
+
+void UndirectedGraph::get_edges(std::vector<std::pair<int,int> > &edges) const
+    // Sets edges to the pairs (i,j) with i<j that are adjacent, in colex order.
+    // The list is computed from the rows rather than cached, since a cache would have to be updated
+    // by the const methods that threads call on a shared graph.
+{
+    edges.clear();
+    for (int j=1; j<n; j++)
+    {
+        const uint64_t *row=get_row(j);
+        for (int w=0; (w<<6)<j; w++)
+            for (uint64_t bits=row[w]; bits; bits&=bits-1)
+            {
+                int i=(w<<6)+__builtin_ctzll(bits);
+                if (i>=j)
+                    break;
+                edges.push_back(std::make_pair(i,j));
+            }
+    }
 }
 
 
@@ -0,0 +1,179 @@
+
+// graphinput.h
+// This is a C++ library for reading the lines of a file of graphs without copying them.
+// The library is contained in one header file to enable use of inline functions.
+
+// Copyright 2017, Stephen G. Hartke
+// Licensed under the GPL version 3.
+
+
+#pragma once  // for compilers that support this
+#ifndef GRAPHINPUT_H__EIGHOOTHAHSHEEKOOQUE  // include guard
+#define GRAPHINPUT_H__EIGHOOTHAHSHEEKOOQUE
+
+
+#include <vector>
+#include <cstdio>  // for printf
+#include <cstdlib>  // for exit
+#include <cstring>  // for memchr and memmove
+#include <cerrno>
+#include <fcntl.h>  // for open
+#include <unistd.h>  // for read, close, lseek, and sysconf
+#include <sys/mman.h>  // for mmap
+#include <sys/stat.h>  // for fstat
+
+
+/* Inputs such as the output of geng can be several GB of short lines, so reading them with std::getline,
+ * which copies each line into a std::string, is a noticeable part of the running time.
+ * Instead, a regular file (including stdin when it is redirected from a file) is mapped into memory with mmap,
+ * and each line is returned as a pointer into the mapping and a length.
+ * The mapping starts at the current offset of the file, since a wrapper script may already have read part of stdin;
+ * mmap needs an offset that is a multiple of the page size, so the bytes before the offset in its page are skipped.
+ * Other inputs, such as pipes, are read in large blocks into a buffer, and the lines are returned as pointers into the buffer.
+ *
+ * The lines are not zero terminated, and a line is only valid until the next call of next_line.
+ */
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+class GraphInput
+////////////////////////////////////////////////////////////////////////////////////////
+{
+public:
+    GraphInput(const char *filename);  // NULL for stdin
+    ~GraphInput();
+
+    bool next_line(const char *&line,size_t &length);
+    bool next_graph(const char *&line,size_t &length);
+
+private:
+    static const size_t block_size=1<<20;  // for reading inputs that cannot be mapped
+
+    int fd;
+    bool close_fd;
+    const char *data;  // the mapping, or the buffer
+    size_t size;  // the number of bytes at data
+    size_t position;  // the start of the next line
+    bool mapped;
+    bool end_of_file;  // for the buffer, whether read has reached the end of the input
+    std::vector<char> buffer;
+
+    bool fill();
+};
+
+
+GraphInput::GraphInput(const char *filename)
+  : // initializer list
+    fd(0),
+    close_fd(false),
+    data(NULL),
+    size(0),
+    position(0),
+    mapped(false),
+    end_of_file(false)
+{
+    if (filename!=NULL)
+    {
+        fd=open(filename,O_RDONLY);
+        if (fd<0)
+        {
+            printf("Could not open the input file %s.\n",filename);
+            exit(8);
+        }
+        close_fd=true;
+    }
+
+    struct stat info;
+    off_t offset=lseek(fd,0,SEEK_CUR);
+    if ((fstat(fd,&info)==0) && S_ISREG(info.st_mode) && (offset>=0) && (info.st_size>offset))
+    {
+        off_t page_start=offset-offset%sysconf(_SC_PAGESIZE);
+        size_t length=info.st_size-page_start;
+        void *mapping=mmap(NULL,length,PROT_READ,MAP_PRIVATE,fd,page_start);
+        if (mapping!=MAP_FAILED)
+        {
+            madvise(mapping,length,MADV_SEQUENTIAL);
+            data=(const char*)mapping;
+            size=length;
+            position=offset-page_start;
+            mapped=true;
+        }
+    }
+}
+
+
+GraphInput::~GraphInput()
+{
+    if (mapped)
+        munmap((void*)data,size);
+    if (close_fd)
+        close(fd);
+}
+
+
+bool GraphInput::fill()
+    // Moves the partial line at the end of the buffer to the beginning, and reads another block after it.
+    // Returns false if there is nothing more to read.
+{
+    if (end_of_file)
+        return false;
+
+    size_t remaining=size-position;
+    if (buffer.size()<remaining+block_size)
+        buffer.resize(remaining+block_size);  // only grows for lines longer than a block
+    memmove(&buffer[0],&buffer[position],remaining);  // buffer is not empty, since block_size>0
+    position=0;
+    size=remaining;
+
+    ssize_t num_read;
+    do
+        num_read=read(fd,&buffer[size],buffer.size()-size);
+    while ((num_read<0) && (errno==EINTR));
+    if (num_read<=0)
+        end_of_file=true;
+    else
+        size+=num_read;
+    data=&buffer[0];
+
+    return (num_read>0);
+}
+
+
+bool GraphInput::next_line(const char *&line,size_t &length)
+    // Sets line and length to the next line, without the newline, and returns false at the end of the input.
+{
+    while (true)
+    {
+        const char *newline=(position<size) ? (const char*)memchr(data+position,'\n',size-position) : NULL;
+        if (newline!=NULL)
+        {
+            line=data+position;
+            length=newline-line;
+            position+=length+1;
+            return true;
+        }
+
+        if (mapped || !fill())
+        {
+            if (position==size)
+                return false;
+            line=data+position;  // the last line has no newline
+            length=size-position;
+            position=size;
+            return true;
+        }
+    }
+}
+
+
+bool GraphInput::next_graph(const char *&line,size_t &length)
+    // Like next_line, but skips the lines that are comments, which start with '>', and the lines too short to be graphs.
+{
+    while (next_line(line,length))
+        if ((length>3) && (line[0]!='>'))
+            return true;
+    return false;
+}
+
+
+#endif  // GRAPHINPUT_H__EIGHOOTHAHSHEEKOOQUE
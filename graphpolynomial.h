@@ -0,0 +1,215 @@
+
+// graphpolynomial.h
+// This is a C++ library for computing a coefficient of the graph polynomial of an fgraph.
+// The library is contained in one header file to enable use of inline functions.
+
+// Copyright 2017, Stephen G. Hartke
+// Licensed under the GPL version 3.
+
+
+#pragma once  // for compilers that support this
+#ifndef GRAPHPOLYNOMIAL_H__WAEVOHGHAIPEIXEIKAIL  // include guard
+#define GRAPHPOLYNOMIAL_H__WAEVOHGHAIPEIXEIKAIL
+
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <algorithm>  // for min and max
+#include "fgraph.h"
+
+
+/* The graph polynomial of G is the product of (x_i - x_j) over the edges ij of G with i<j.
+ * The Combinatorial Nullstellensatz needs the coefficient of the monomial with exponent f[i]-1 on x_i.
+ *
+ * Expanding the product term by term takes time proportional to the number of terms, which is exponential in the number of edges.
+ * Instead, we multiply in the factors one at a time, and keep the partial product as a map from exponent vectors to coefficients.
+ * Terms with an exponent above f[i]-1 can never contribute, and neither can terms where the exponent of x_i
+ * plus the number of remaining factors containing x_i is below f[i]-1, so both are dropped.
+ * Once all of the factors containing x_i have been multiplied in, every remaining term has exponent f[i]-1 on x_i.
+ * Hence the terms only differ on the vertices that have some, but not all, of their edges multiplied in,
+ * and we order the edges to keep this frontier small.
+ *
+ * The coefficients are computed either exactly, as 128 bit integers, or modulo a prime.
+ * A nonzero coefficient modulo the prime is also nonzero exactly, so the modular computation never gives a false proof of choosability.
+ */
+
+
+typedef __int128 coefficient_t;  // the coefficients can exceed 64 bits only for graphs far larger than we can check
+
+
+std::string coefficient_to_string(coefficient_t x)
+    // printf cannot print 128 bit integers.
+{
+    if (x==0)
+        return "0";
+
+    bool negative=(x<0);
+    std::string digits;
+    while (x!=0)
+    {
+        int digit=(int)(x%10);
+        digits.insert(digits.begin(),'0'+(negative ? -digit : digit));
+        x/=10;
+    }
+    if (negative)
+        digits.insert(digits.begin(),'-');
+    return digits;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+class GraphPolynomial
+////////////////////////////////////////////////////////////////////////////////////////
+{
+public:
+    int n;
+    std::vector<int> target;  // the exponent f[i]-1 that x_i must have
+    std::vector<std::pair<int,int> > edges;  // in the order they are multiplied in; the first vertex is the lower one
+    int max_frontier;  // the largest number of vertices with some, but not all, of their edges multiplied in
+
+    GraphPolynomial(const fGraph &G);
+
+    coefficient_t coefficient();
+    unsigned long long int coefficient_mod(unsigned long long int p);
+
+private:
+    template <typename count_t>
+    count_t multiply(count_t modulus);
+};
+
+
+GraphPolynomial::GraphPolynomial(const fGraph &G)
+  : // initializer list
+    n(G.n),
+    target(G.n),
+    max_frontier(0)
+{
+    for (int i=n-1; i>=0; i--)
+        target[i]=G.f[i]-1;
+
+    // We add the vertices one at a time, each time choosing the vertex with the most neighbors already added,
+    // and breaking ties by the fewest neighbors not yet added.
+    // When a vertex is added, the edges to the neighbors already added are multiplied in.
+    std::vector<char> added(n,false);
+    std::vector<int> remaining(G.degree.begin(),G.degree.begin()+n);  // the number of neighbors not yet added
+    std::vector<int> added_neighbors(n,0);
+
+    int frontier=0;
+    for (int k=0; k<n; k++)
+    {
+        int best=-1;
+        for (int v=0; v<n; v++)
+            if (!added[v] && ( (best==-1) ||
+                               (added_neighbors[v]>added_neighbors[best]) ||
+                               ((added_neighbors[v]==added_neighbors[best]) && (remaining[v]<remaining[best])) ))
+                best=v;
+
+        added[best]=true;
+        if (remaining[best]>0)
+            frontier++;
+        const uint64_t *row=G.get_row(best);
+        for (int w=0; w<G.words_per_row; w++)
+            for (uint64_t bits=row[w]; bits; bits&=bits-1)
+            {
+                int u=(w<<6)+__builtin_ctzll(bits);
+                remaining[u]--;
+                if (added[u])
+                {
+                    edges.push_back(std::make_pair(std::min(u,best),std::max(u,best)));
+                    if (remaining[u]==0)
+                        frontier--;
+                }
+                else
+                    added_neighbors[u]++;
+            }
+        if (frontier>max_frontier)
+            max_frontier=frontier;
+    }
+}
+
+
+template <typename count_t>
+count_t GraphPolynomial::multiply(count_t modulus)
+    // Returns the coefficient, modulo modulus if it is not 0.
+    // The exponent vectors are stored as strings, one char per vertex.
+{
+    typedef std::unordered_map<std::string,count_t> Terms;
+
+    std::vector<int> remaining(n,0);  // the number of factors containing x_i that have not been multiplied in
+    for (size_t e=0; e<edges.size(); e++)
+    {
+        remaining[edges[e].first]++;
+        remaining[edges[e].second]++;
+    }
+    for (int i=n-1; i>=0; i--)
+        if (remaining[i]<target[i])
+            return 0;  // also covers isolated vertices, since f[i]>=2
+
+    Terms terms, next;
+    terms[std::string(n,0)]=1;
+
+    for (size_t e=0; e<edges.size(); e++)
+    {
+        int i=edges[e].first;
+        int j=edges[e].second;
+        remaining[i]--;
+        remaining[j]--;
+
+        next.clear();
+        for (typename Terms::iterator it=terms.begin(); it!=terms.end(); ++it)
+        {
+            if (it->second==0)
+                continue;  // the terms cancelled
+            
+            std::string exponents=it->first;
+            int ei=exponents[i], ej=exponents[j];
+
+            // The x_i term of the factor, with sign +.  The exponent of x_j stays at ej, and so must still reach its target.
+            if ((ei<target[i]) && (ej+remaining[j]>=target[j]))
+            {
+                exponents[i]=ei+1;
+                count_t &c=next[exponents];
+                c+=it->second;
+                if ((modulus!=0) && (c>=modulus))
+                    c-=modulus;
+                exponents[i]=ei;
+            }
+
+            // The x_j term, with sign -.
+            if ((ej<target[j]) && (ei+remaining[i]>=target[i]))
+            {
+                exponents[j]=ej+1;
+                count_t &c=next[exponents];
+                if (modulus!=0)
+                    c=(c>=it->second) ? c-it->second : c+(modulus-it->second);
+                else
+                    c-=it->second;
+            }
+        }
+        terms.swap(next);
+
+        if (terms.empty())
+            return 0;
+    }
+
+    // Only the target monomial can be left.
+    typename Terms::iterator it=terms.begin();
+    return (it==terms.end()) ? 0 : it->second;
+}
+
+
+coefficient_t GraphPolynomial::coefficient()
+{
+    return multiply<coefficient_t>(0);
+}
+
+
+unsigned long long int GraphPolynomial::coefficient_mod(unsigned long long int p)
+    // p must be less than 2^63, so that the sum of two residues does not overflow.
+{
+    return multiply<unsigned long long int>(p);
+}
+
+
+#endif  // GRAPHPOLYNOMIAL_H__WAEVOHGHAIPEIXEIKAIL
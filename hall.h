@@ -0,0 +1,269 @@
+
+// hall.h
+// This is a C++ library for quickly showing that some partial list assignments have no feasible coloring, by matching colors on cliques.
+// The library is contained in one header file to enable use of inline functions.
+
+// Copyright 2017, Stephen G. Hartke
+// Licensed under the GPL version 3.
+
+
+#pragma once  // for compilers that support this
+#ifndef HALL_H__OOGHAEPAIQUAIXOHSHEI  // include guard
+#define HALL_H__OOGHAEPAIQUAIXOHSHEI
+
+
+#include <vector>
+#include <algorithm>  // for sort
+#include "bitarray.h"
+#include "colorabilityclass.h"
+
+
+/* Most of the partial list assignments checked by has_feasible_coloring have no feasible coloring,
+ * and many of them for a simple counting reason, which the backtracking of find_feasible_coloring only finds after trying many colorings.
+ * The vertices of a clique need distinct colors, so a feasible coloring matches the vertices of each clique to distinct colorability classes
+ * that contain them.  By Hall's theorem, there is no such matching if some set of the vertices meets fewer classes than it has vertices.
+ * HallFilter checks that each clique has such a matching, and that every vertex is in some class.
+ * If either fails, the partial list assignment has no feasible coloring.  Otherwise, the exact check is still needed.
+ *
+ * has_feasible_coloring is called for each class generated on a level, with the same classes below it, so the filter is incremental.
+ * Adding one class to the classes below the level increases the size of a maximum matching of a clique by at most 1.
+ * So for each clique, the classes below the level are matched once, and all of the vertices are matched, or all but one;
+ * otherwise no class on the level can complete the matching.  With one vertex unmatched, the new class completes the matching
+ * exactly when it contains a vertex that some maximum matching leaves unmatched, which are the vertices reached from the unmatched vertex
+ * by alternating paths.  Thus checking a class is an and for each clique.
+ * The matchings of a level are recomputed when its undo_frame changes, since each setup of a level has a new frame (see subgraph.h),
+ * and they are usually extended from the level below, without matching again.
+ *
+ * The cliques are the maximal cliques of the graph with at least 2 vertices, found by the Bron-Kerbosch algorithm with pivoting.
+ * At most max_cliques are kept, the largest first, since graphs can have exponentially many maximal cliques.
+ */
+
+
+template <typename bitarray_t>
+////////////////////////////////////////////////////////////////////////////////////////
+class HallFilter
+////////////////////////////////////////////////////////////////////////////////////////
+{
+public:
+    static const size_t max_cliques=64;
+    
+    int n;
+    std::vector<bitarray_t> cliques;  // largest first
+    bool active;  // whether the filter is used; compute sets it, and clear resets it
+    unsigned long long int hits, misses;  // the partial list assignments shown to have no feasible coloring, and the ones passed on to the exact check
+    
+    HallFilter();
+    
+    void compute(int n,const std::vector<bitarray_t> &neighbors,int num_levels);
+    void clear();
+    bool enabled() const;
+    bool infeasible(const std::vector<ColorabilityClassInfo<bitarray_t> > &color_info,int cur_color);
+
+private:
+    // These are indexed by level, for the classes below the level.
+    std::vector<unsigned long long int> frame;  // the undo_frame of the level when it was matched; 0 if it has not been
+    std::vector<bitarray_t> covered;  // the vertices in some class
+    std::vector<char> hopeless;  // whether some clique has at least 2 vertices unmatched
+    std::vector<bitarray_t> completing;  // indexed by level*cliques.size()+k; a class completes the matching of clique k if it meets this
+    
+    std::vector<int> matched;  // indexed by color; the vertex matched to the color, or -1
+    std::vector<char> visited;  // indexed by color
+    
+    void find_cliques(const std::vector<bitarray_t> &neighbors,bitarray_t clique,bitarray_t candidates,bitarray_t excluded);
+    bool augment(const std::vector<ColorabilityClassInfo<bitarray_t> > &color_info,int level,int v);
+    void match_level(const std::vector<ColorabilityClassInfo<bitarray_t> > &color_info,int level);
+};
+
+
+template <typename bitarray_t>
+HallFilter<bitarray_t>::HallFilter()
+  : // initializer list
+    n(0),
+    active(false),
+    hits(0),
+    misses(0)
+{
+}
+
+
+template <typename bitarray_t>
+void HallFilter<bitarray_t>::compute(int n,const std::vector<bitarray_t> &neighbors,int num_levels)
+{
+    this->n=n;
+    cliques.clear();
+    find_cliques(neighbors,0,((bitarray_t)1<<n)-1,0);
+    std::sort(cliques.begin(),cliques.end(),[](const bitarray_t &a,const bitarray_t &b) { return popcount(a)>popcount(b); });
+    if (cliques.size()>max_cliques)
+        cliques.resize(max_cliques);
+    
+    frame.assign(num_levels,0);
+    covered.resize(num_levels);
+    hopeless.resize(num_levels);
+    completing.resize(num_levels*cliques.size());
+    matched.resize(num_levels);
+    visited.resize(num_levels);
+    
+    active=true;
+    hits=0;
+    misses=0;
+}
+
+
+template <typename bitarray_t>
+void HallFilter<bitarray_t>::clear()
+{
+    cliques.clear();
+    active=false;
+    hits=0;
+    misses=0;
+}
+
+
+template <typename bitarray_t>
+inline
+bool HallFilter<bitarray_t>::enabled() const
+{
+    return active;
+}
+
+
+template <typename bitarray_t>
+void HallFilter<bitarray_t>::find_cliques(const std::vector<bitarray_t> &neighbors,bitarray_t clique,bitarray_t candidates,bitarray_t excluded)
+    // Adds the maximal cliques that contain clique and are contained in clique|candidates, and that contain no vertex of excluded.
+{
+    if ((candidates==0) && (excluded==0))
+    {
+        if (popcount(clique)>=2)
+            cliques.push_back(clique);
+        return;
+    }
+    if (cliques.size()>=4*max_cliques)
+        return;  // enough to choose the largest from
+    
+    int pivot=lowest_bit(candidates|excluded);  // only the pivot and its non-neighbors need to start a clique
+    bitarray_t rest=candidates & ~neighbors[pivot];
+    for ( ; rest!=0; rest&=rest-1)
+    {
+        int v=lowest_bit(rest);
+        bitarray_t v_mask=(bitarray_t)1<<v;
+        find_cliques(neighbors,clique|v_mask,candidates & neighbors[v],excluded & neighbors[v]);
+        candidates&=~v_mask;
+        excluded|=v_mask;
+    }
+}
+
+
+template <typename bitarray_t>
+bool HallFilter<bitarray_t>::augment(const std::vector<ColorabilityClassInfo<bitarray_t> > &color_info,int level,int v)
+    // Looks for an augmenting path from the vertex v through the classes below level (Kuhn's algorithm).
+{
+    bitarray_t v_mask=(bitarray_t)1<<v;
+    for (int c=level-1; c>=0; c--)
+        if ((color_info[c].colorability_class & v_mask) && !visited[c])
+        {
+            visited[c]=true;
+            if ((matched[c]<0) || augment(color_info,level,matched[c]))
+            {
+                matched[c]=v;
+                return true;
+            }
+        }
+    return false;
+}
+
+
+template <typename bitarray_t>
+void HallFilter<bitarray_t>::match_level(const std::vector<ColorabilityClassInfo<bitarray_t> > &color_info,int level)
+{
+    frame[level]=color_info[level].undo_frame;
+    
+    if ((level>0) && (frame[level-1]==color_info[level-1].undo_frame) && !hopeless[level-1])
+    {
+        // The level below is matched, so its matchings are extended by its class.
+        // If the class does not complete the matching of a clique, it is an unmatched class that no alternating path reaches,
+        // so the vertices that some maximum matching leaves unmatched are the same.
+        const bitarray_t &added=color_info[level-1].colorability_class;
+        covered[level]=covered[level-1] | added;
+        hopeless[level]=false;
+        const bitarray_t *completing_below=&completing[(level-1)*cliques.size()];
+        bitarray_t *completing_level=&completing[level*cliques.size()];
+        for (size_t k=0; k<cliques.size(); k++)
+            completing_level[k]=(added & completing_below[k]) ? ~(bitarray_t)0 : completing_below[k];
+        return;
+    }
+    
+    covered[level]=0;
+    for (int c=level-1; c>=0; c--)
+        covered[level]|=color_info[c].colorability_class;
+    hopeless[level]=false;
+    
+    for (size_t k=0; k<cliques.size(); k++)
+    {
+        bitarray_t unmatched=0;
+        std::fill(matched.begin(),matched.begin()+level,-1);
+        for (bitarray_t rest=cliques[k]; rest!=0; rest&=rest-1)
+        {
+            std::fill(visited.begin(),visited.begin()+level,false);
+            int v=lowest_bit(rest);
+            if (!augment(color_info,level,v))
+                unmatched|=(bitarray_t)1<<v;
+        }
+        
+        bitarray_t &completing_k=completing[level*cliques.size()+k];
+        if (unmatched==0)
+            completing_k=~(bitarray_t)0;  // every class does
+        else if (popcount(unmatched)>=2)
+        {
+            hopeless[level]=true;
+            return;
+        }
+        else
+        {
+            // The vertices reached from the unmatched vertex by alternating paths.
+            completing_k=unmatched;
+            std::fill(visited.begin(),visited.begin()+level,false);
+            for (bitarray_t frontier=unmatched; frontier!=0; )
+            {
+                bitarray_t next=0;
+                for ( ; frontier!=0; frontier&=frontier-1)
+                {
+                    bitarray_t w_mask=(bitarray_t)1<<lowest_bit(frontier);
+                    for (int c=level-1; c>=0; c--)
+                        if ((color_info[c].colorability_class & w_mask) && !visited[c])
+                        {
+                            visited[c]=true;
+                            next|=(bitarray_t)1<<matched[c];  // the class is matched, since the matching is maximum
+                        }
+                }
+                frontier=next & ~completing_k;
+                completing_k|=next;
+            }
+        }
+    }
+}
+
+
+template <typename bitarray_t>
+inline
+bool HallFilter<bitarray_t>::infeasible(const std::vector<ColorabilityClassInfo<bitarray_t> > &color_info,int cur_color)
+    // Returns true if the colorability classes 0..cur_color fail one of the conditions, and so have no feasible coloring.
+{
+    if (frame[cur_color]!=color_info[cur_color].undo_frame)
+        match_level(color_info,cur_color);
+    
+    const bitarray_t &added=color_info[cur_color].colorability_class;
+    bool result=hopeless[cur_color] || ((covered[cur_color] | added)!=((bitarray_t)1<<n)-1);
+    const bitarray_t *completing_level=&completing[cur_color*cliques.size()];
+    for (size_t k=0; (k<cliques.size()) && !result; k++)
+        if ((added & completing_level[k])==0)
+            result=true;
+    
+    if (result)
+        hits++;
+    else
+        misses++;
+    return result;
+}
+
+
+#endif  // HALL_H__OOGHAEPAIQUAIXOHSHEI
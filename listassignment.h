@@ -13,54 +13,197 @@
 
 
 #include <vector>
+#include <atomic>
+#include <algorithm>  // for sort
+#include <random>  // for the choices of probe
 #include "bitarray.h"
+#include "boundedcache.h"
+#include "automorphism.h"
 #include "subgraph.h"
 #include "colorabilityclass.h"
+#include "taskpool.h"
+#include "checkpoint.h"
+#include "statistics.h"
+#include "estimator.h"
+#include "hall.h"
+#include "witnesspool.h"
+#include "feasibilitycache.h"
 
 
+struct TranspositionLevel
+    // How much the transposition table saves on one level of the stack, which decides whether the level uses it (see check_transposition_table).
+{
+    unsigned long long int lookups, hits;
+    unsigned long long int recorded, nodes;  // the subtrees recorded when backtracking, and the sum of their counts
+    unsigned long long int start_count;  // count when the key of the current subtree was made
+    bool used;
+    
+    TranspositionLevel() : lookups(0), hits(0), recorded(0), nodes(0), start_count(0), used(true) {}
+};
+
+
+template <typename bitarray_t, typename statistics_t=NoStatistics>
 ////////////////////////////////////////////////////////////////////////////////////////
 class ListAssignment
 ////////////////////////////////////////////////////////////////////////////////////////
 {
 public:
     int n;  // number of vertices in the whole graph
-    const std::vector<bitarray> &neighbors;  // adjacencies in the graph
+    const std::vector<bitarray_t> &neighbors;  // adjacencies in the graph
+    const NeighborhoodTable<bitarray_t> &neighborhood;  // used by the subgraph generators
     const std::vector<int> &f;  // the f vector of allowed list sizes
     
-    std::vector<ColorabilityClassInfo> color_info;
+    std::vector<ConnectedSubgraph<bitarray_t> > generator;  // subgraph generators rooted at each vertex, shared by all levels of color_info
+    SubgraphUndoLog<bitarray_t> undo_log;  // used to restore the generators when backtracking
+    std::vector<ColorabilityClassInfo<bitarray_t> > color_info;
     int cur_color;  // the current (and last) colorability class; thus there are cur_color+1 total colorability classes
     
     std::vector<int> assigned_color;
-    std::vector<bitarray> color_class;  // indexed by color; indicates which vertices have been assigned this color
-    std::vector<bitarray> prev_neighbors;
+    std::vector<bitarray_t> color_class;  // indexed by color; indicates which vertices have been assigned this color
+    std::vector<bitarray_t> prev_neighbors;
+    
+    FeasibilityCache<bitarray_t> feasibility_cache;  // whether multisets of colorability classes have a feasible coloring; not used until resized
+    HallFilter<bitarray_t> hall_filter;  // counting conditions that are checked before searching for a feasible coloring; not used until computed
+    WitnessPool<bitarray_t> witness_pool;  // the feasible colorings of the previous classes on each level, checked first; not used until resized
+    
+    // The subtree below a new level of the stack is determined by the multiset of colorability classes below it,
+    // the eligible vertices and generators of the level, and the state of the eligible generators.
+    // Different paths can arrive at the same state, so we record the states whose subtrees have been fully searched without finding a bad list assignment.
+    BoundedCache<std::vector<bitarray_t>,bool,BitArrayVectorHash<bitarray_t> > transposition_table;  // disabled unless its max_entries is set
+    std::vector<std::vector<bitarray_t> > transposition_key;  // indexed by level; the key of the level when it was new
+    std::vector<char> transposition_keyed;  // indexed by level; whether transposition_key is set and should be recorded when backtracking
+    std::vector<TranspositionLevel> transposition_level;  // indexed by level
+    static const unsigned long long int transposition_sample=1024;  // the lookups of a level before deciding whether it pays
+    static const int transposition_min_saving=8;  // the nodes that a lookup must save on average to pay for making its key
+    
+    // The state of the search.  These are members so that the search can be split between threads.
+    unsigned long long int count, num_feasible_colorings;
+    int res,mod,splitlevel,odometer;  // for parallelization with separate processes
+    // With -r/-m, the levels up to splitlevel are searched by every residue, and these counts let the residues be combined (see coordinator.h).
+    unsigned long long int shared_count, shared_feasible_colorings;  // the parts of count and num_feasible_colorings at the levels up to splitlevel
+    unsigned long long int num_split_nodes, num_expanded_nodes;  // the nodes at splitlevel, and the ones of them with residue res
+    int base_color;  // the lowest level of the stack that this search is responsible for
+    TaskPool<SearchTask<bitarray_t> > *pool;  // for sharing the search with other threads; NULL if there is only one thread
+    int thread_id;  // the index of this thread in pool
+    OrbitPruner<bitarray_t> *orbit_pruner;  // for skipping classes on level 0 that are images of earlier ones under automorphisms; NULL if not used
+    Checkpointer *checkpointer;  // for saving the state of the search; NULL if not used
+    ProgressReporter *progress;  // for reporting the count and the time remaining; NULL if not used
+    const std::vector<int> *labels;  // the input label of each vertex, which print_bad_list uses when the fgraph was relabeled (see ordering.h); NULL if not used
+    const std::atomic<bool> *cancel;  // when set by another thread, the search stops without a result; NULL if not used
+    unsigned long long int max_count;  // like cancel, the search stops without a result once count reaches this; 0 for no limit
+    bool cancelled;  // whether the search stopped because of cancel or max_count
+    std::vector<SearchTask<bitarray_t>*> resumed_tasks;  // when resuming, the saved levels that are continued after the levels above them
+    statistics_t statistics;  // see statistics.h
+    FILE *out;  // where the search reports its progress and results; stdout unless the caller collects the output of each graph; NULL for none, as for probes
     
 // methods:
     ListAssignment(
         int n,
-        const std::vector<bitarray> &neighbors,
-        const std::vector<int> &f);
+        const std::vector<bitarray_t> &neighbors,
+        const NeighborhoodTable<bitarray_t> &neighborhood,
+        const std::vector<int> &f,
+        FILE *out=stdout);
     
+    void reset(int n);
     bool has_feasible_coloring();
+    bool find_feasible_coloring();
     bool verify(int res,int mod,int splitlevel);
+    bool resume(const CheckpointState<bitarray_t> &state,int res,int mod,int splitlevel);
+    bool search();
+    bool push_colorability_class();
+    void pop_colorability_class();
+    double probe(std::mt19937 &random,bool &found_bad_list);
+    void make_transposition_key(std::vector<bitarray_t> &key) const;
+    bool check_transposition_table();
+    bitarray_t input_labels(bitarray_t x) const;
+    void print_bad_list() const;
+    
+    void donate_base_level();
+    void load_task(const SearchTask<bitarray_t> &task);
+    void save_checkpoint();
 };
 
 
-ListAssignment::ListAssignment(
+template <typename bitarray_t, typename statistics_t>
+ListAssignment<bitarray_t,statistics_t>::ListAssignment(
     int n,
-    const std::vector<bitarray> &neighbors,
-    const std::vector<int> &f)
+    const std::vector<bitarray_t> &neighbors,
+    const NeighborhoodTable<bitarray_t> &neighborhood,
+    const std::vector<int> &f,
+    FILE *out)
   :  // initializer list
-    n(n),
+    n(-1),  // nothing is allocated until reset
     neighbors(neighbors),
-    f(f)
+    neighborhood(neighborhood),
+    f(f),
+    count(0),
+    num_feasible_colorings(0),
+    res(-1),
+    mod(-1),
+    splitlevel(-1),  // never split
+    odometer(-1),
+    shared_count(0),
+    shared_feasible_colorings(0),
+    num_split_nodes(0),
+    num_expanded_nodes(0),
+    base_color(0),
+    pool(NULL),
+    thread_id(0),
+    orbit_pruner(NULL),
+    checkpointer(NULL),
+    progress(NULL),
+    labels(NULL),
+    cancel(NULL),
+    max_count(0),
+    cancelled(false),
+    out(out)
 {
     //printf("ListAssignment constructor.\n");
     
+    reset(n);
+}
+
+
+template <typename bitarray_t, typename statistics_t>
+void ListAssignment<bitarray_t,statistics_t>::reset(int n)
+{
+    // Sets up the stack for a new search, of the graph now given by neighbors, neighborhood, and f.
+    // This lets a thread that checks many graphs reuse one ListAssignment; the memory is only reallocated if n or the sum of f changes.
+    
     int sum=0;
     for (int i=n-1; i>=0; i--)
         sum+=f[i];
-    printf("Reserving colorability class info stack to size %d\n",sum);
-    color_info.resize(sum,ColorabilityClassInfo(n,neighbors));
+    if (statistics_t::enabled && (out!=NULL))
+        fprintf(out,"Reserving colorability class info stack to size %d\n",sum);  // a diagnostic, so only reported with statistics
+    if ((n!=this->n) || (sum!=(int)color_info.size()))
+    {
+        this->n=n;
+        
+        // The generators and colorability class infos hold references, so they cannot be assigned, only copy constructed.
+        generator.clear();
+        for (int i=0; i<n; i++)
+            generator.push_back(ConnectedSubgraph<bitarray_t>(n,neighborhood));
+        color_info.clear();
+        color_info.resize(sum,ColorabilityClassInfo<bitarray_t>(n,neighbors,generator,undo_log));
+        
+        // These are used for backtracking checking of feasible colorings.
+        assigned_color.resize(n);  // initialize the size of the assigned colors array
+        color_class.resize(sum);
+        prev_neighbors.resize(n);
+        
+        transposition_key.resize(sum);
+        transposition_keyed.resize(sum);
+        transposition_level.resize(sum);
+    }
+    
+    undo_log.clear();
+    cancelled=false;
+    feasibility_cache.clear();
+    transposition_table.clear();
+    for (int i=sum-1; i>=0; i--)
+        transposition_keyed[i]=false;
+    transposition_level.assign(sum,TranspositionLevel());
+    statistics=statistics_t();
     
     // intialize the stack for the first colorability class
     cur_color=0;
@@ -74,11 +217,13 @@ ListAssignment::ListAssignment(
         color_info[cur_color].eligible_vertices|=(f[i]>0);  // mark vertices eligible if they have room in their lists
     }
     color_info[cur_color].eligible_generators=color_info[cur_color].eligible_vertices;
+    color_info[cur_color].undo_mark=0;
+    color_info[cur_color].undo_frame=undo_log.frame;
     
-    bitarray mask=1;
+    bitarray_t mask=1;
     for (int i=0; i<n; i++)  // we need a separate loop since eligible_vertices must be computed
     {
-        color_info[cur_color].generator[i].initialize(
+        generator[i].initialize(
             i,  // root
             color_info[cur_color].eligible_vertices & mask);
                 // the eligible vertices are only those with lower index (or the same) as the root
@@ -95,14 +240,8 @@ ListAssignment::ListAssignment(
         mask|=1;  // and put a 1 in the low order bit
     }
     
-    
-    // These are used for backtracking checking of feasible colorings.
-    assigned_color.resize(n);  // initialize the size of the assigned colors array
-    color_class.resize(color_info.size());
-    
     // set up the previous neighbors bitarrays for backtracking checking of feasible colorings
-    prev_neighbors.resize(n);
-    mask=(1<<n)-1;  // declared as bitarray above; has the n lowest order 1s
+    mask=((bitarray_t)1<<n)-1;  // declared as bitarray above; has the n lowest order 1s
     for (int i=n-1; i>=0; i--)
     {
         prev_neighbors[i]=neighbors[i] & mask;
@@ -113,15 +252,53 @@ ListAssignment::ListAssignment(
 }
 
 
+template <typename bitarray_t, typename statistics_t>
+inline
+bool ListAssignment<bitarray_t,statistics_t>::has_feasible_coloring()
+{
+    // Returns true if the partial list assignment given by the colorability classes 0..cur_color has a feasible coloring.
+    if (witness_pool.enabled() && witness_pool.lookup(cur_color,color_info[cur_color].undo_frame,color_info[cur_color].colorability_class))
+        return true;  // a feasible coloring of a previous class on this level also colors this one (see witnesspool.h)
+    
+    if (!feasibility_cache.enabled())
+    {
+        bool result=find_feasible_coloring();
+        statistics.feasibility_check(cur_color,result);
+        return result;
+    }
+    
+    bool result;
+    if (feasibility_cache.lookup(color_info,cur_color,result))
+        return result;  // the same multiset of classes was checked before (see feasibilitycache.h)
+    
+    result=find_feasible_coloring();
+    statistics.feasibility_check(cur_color,result);
+    feasibility_cache.insert(color_info,cur_color,result);
+    return result;
+}
+
+
+template <typename bitarray_t, typename statistics_t>
 inline
-bool ListAssignment::has_feasible_coloring()
+bool ListAssignment<bitarray_t,statistics_t>::find_feasible_coloring()
 {
+    if (hall_filter.enabled() && hall_filter.infeasible(color_info,cur_color))
+        return false;  // some vertex or clique has too few colors (see hall.h)
+    
     // clear the data structures
     for (int i=cur_color; i>=0; i--)
         color_class[i]=0;  // no vertices have been assigned this color
-    
+
+    // The search is incremental with respect to the colorability class stack.
+    // verify() only pushes a colorability class after has_feasible_coloring() fails, so the classes 0..cur_color-1
+    // have already been shown to have no feasible coloring.  Hence any feasible coloring must use color cur_color.
+    // Vertices are colored in order, so once the search advances past the last vertex of colorability_class
+    // without having used cur_color, it is inside a subtree that the previous call already exhausted, and we backtrack.
+    // Note that color_info[cur_color].colorability_class is never empty.
+    int last_vertex=highest_bit(color_info[cur_color].colorability_class);
+
     int v=0;
-    bitarray v_mask=1;  // has a 1 in bit position v
+    bitarray_t v_mask=1;  // has a 1 in bit position v
     
     assigned_color[v]=0;
     
@@ -158,7 +335,7 @@ bool ListAssignment::has_feasible_coloring()
         //*/
         
         /*/ Sanity check that assigned_color[] and color_class[] have the same information.
-        bitarray mask=1;
+        bitarray_t mask=1;
         for (int i=0; i<=v; i++)  // vertex
         {
             if ((mask & vertices_to_skip)==0)
@@ -214,8 +391,16 @@ bool ListAssignment::has_feasible_coloring()
                 if (v>=n)  // we could replace this with an & test
                 {
                     //printf("We have found a feasible coloring!\n");
+                    if (witness_pool.enabled())
+                        witness_pool.insert(cur_color,color_info[cur_color].undo_frame,color_class[cur_color]);
                     return true;
                 }
+                else if ((v>last_vertex) && (color_class[cur_color]==0))
+                {
+                    // cur_color can no longer be used, so this subtree has no feasible coloring.
+                    // Marking v as out of colors makes the next pass through the loop backtrack.
+                    assigned_color[v]=cur_color+1;
+                }
                 else
                 {
                     // we check the next vertex; initialize the color we check to 0.
@@ -229,6 +414,7 @@ bool ListAssignment::has_feasible_coloring()
         else  // there are no more colors to try for v
         {
             // hence we must backtrack
+            statistics.coloring_backtrack();
             v--;
             v_mask>>=1;
             
@@ -308,16 +494,90 @@ void print_long(long long int x, int width)
 }
 
 
-bool ListAssignment::verify(int res,int mod,int splitlevel)
+template <typename bitarray_t, typename statistics_t>
+bool ListAssignment<bitarray_t,statistics_t>::verify(int res,int mod,int splitlevel)
 {
-    // This functions contains the main loop that generates and verifies list assignments.
+    // This functions sets up and runs the main loop that generates and verifies list assignments.
+    
+    this->res=res;
+    this->mod=mod;
+    this->splitlevel=splitlevel;
+    odometer=mod;  // for parallelization; keeps track of the number of nodes of the search tree at level splitlevel
+                   // remember that decrementing odometer happens before testing against the residue
+    
+    count=0;
+    num_feasible_colorings=0;
+    shared_count=0;
+    shared_feasible_colorings=0;
+    num_split_nodes=0;
+    num_expanded_nodes=0;
+    base_color=0;  // we search the whole stack
+    
+    if (!search())
+        return false;
+    if (cancelled)
+        return true;  // the caller knows the result is not valid
     
-    unsigned long long int count=0, num_feasible_colorings=0;
-    int odometer=mod;  // for parallelization; keeps track of the number of nodes of the search tree at level splitlevel
-                       // remember that decrementing odometer happens before testing against the residue
+    if (out!=NULL)
+        fprintf(out,"All list assignments checked, final count=%llu, num_feasible_colorings=%llu\n",count,num_feasible_colorings);
+    // No bad list assignment has been found, so the graph is f-choosable.
+    return true;
+}
+
 
-    while (cur_color>=0)
+template <typename bitarray_t, typename statistics_t>
+bool ListAssignment<bitarray_t,statistics_t>::resume(const CheckpointState<bitarray_t> &state,int res,int mod,int splitlevel)
+{
+    // This continues the search saved in a checkpoint (see checkpoint.h).
+    // Each saved level is continued after the levels above it, which is the order of the search that was interrupted.
+    
+    this->res=res;
+    this->mod=mod;
+    this->splitlevel=splitlevel;
+    odometer=state.odometer;
+    
+    count=state.count;
+    num_feasible_colorings=state.num_feasible_colorings;
+    shared_count=0;  // these are not saved, so the coordinator cannot resume
+    shared_feasible_colorings=0;
+    num_split_nodes=0;
+    num_expanded_nodes=0;
+    resumed_tasks=state.tasks;
+    
+    for (int level=(int)state.tasks.size()-1; (level>=0) && !cancelled; level--)
     {
+        load_task(*state.tasks[level]);
+        if (!search())
+            return false;
+    }
+    resumed_tasks.clear();
+    if (cancelled)
+        return true;
+    
+    if (out!=NULL)
+        fprintf(out,"All list assignments checked, final count=%llu, num_feasible_colorings=%llu\n",count,num_feasible_colorings);
+    return true;
+}
+
+
+template <typename bitarray_t, typename statistics_t>
+bool ListAssignment<bitarray_t,statistics_t>::search()
+{
+    // This functions contains the main loop that generates and verifies list assignments.
+    // The search continues from the current state of the stack until cur_color drops below base_color.
+    // Returns false if a bad list assignment is found, and true otherwise.
+    
+    while (cur_color>=base_color)
+    {
+        if (pool!=NULL)  // we are sharing the search with other threads
+        {
+            if (pool->stop_requested())
+                return true;  // another thread found a bad list assignment
+            
+            if ((base_color<cur_color) && pool->hungry())
+                donate_base_level();
+        }
+        
         /*/
         printf("Starting main loop, cur_color=%d\n",cur_color);
         for (int i=0; i<=cur_color; i++)
@@ -348,103 +608,25 @@ bool ListAssignment::verify(int res,int mod,int splitlevel)
             }
         //*/
         
-        count++;
-        if ((count&0xFFFFF)==0) //(1) //((count&0xFFFFF)==0)  //((count&0xFFFFFF)==0)
+        if (((count&1023)==0) && (((cancel!=NULL) && cancel->load(std::memory_order_relaxed)) || ((max_count>0) && (count>=max_count))))
         {
-            printf("\ncount=");// %20llu\n",count);
-            print_long(count,20);
-            printf("     num_feasible_colorings=");
-            print_long(num_feasible_colorings,15);
-            printf("\n");
-        
-            //*/
-            printf("cur_color=%d\n",cur_color);
-            
-            int maxvalue=(cur_color>=n ? cur_color : n-1);
-            for (int i=0; i<=maxvalue; i++)
-            {
-                if (i<cur_color)  // cur_color does not include a valid colorability_class (yet)
-                {
-                    printf("color=%2d  ",i);
-                    print_binary(color_info[i].colorability_class,n);
-                    
-                    /*
-                    if ((i==0) && (cur_color==1) && ((color_info[i].colorability_class&0b100001)==0b100001) && (__builtin_popcountll(color_info[i].colorability_class)==4))
-                        printf("four");
-                    if ((i==0) //&& (cur_color==2) 
-                        &&((color_info[0].colorability_class==0b101101) 
-                         ||(color_info[0].colorability_class==0b110011)
-                         ||(color_info[0].colorability_class==0b001010)
-                         ||(color_info[0].colorability_class==0b010100))
-                       )
-                        printf("this1");
-                    if ((i==1) //&& (cur_color==2) 
-                        &&((color_info[0].colorability_class==0b101101) 
-                         ||(color_info[0].colorability_class==0b110011)
-                         ||(color_info[0].colorability_class==0b001010)
-                         ||(color_info[0].colorability_class==0b010100))
-                        &&((color_info[1].colorability_class==0b101101) 
-                         ||(color_info[1].colorability_class==0b110011)
-                         ||(color_info[1].colorability_class==0b001010)
-                         ||(color_info[1].colorability_class==0b010100))
-                       )
-                        printf("this2");
-                    if ((i==2) //&& (cur_color==2) 
-                        &&((color_info[0].colorability_class==0b101101) 
-                         ||(color_info[0].colorability_class==0b110011)
-                         ||(color_info[0].colorability_class==0b001010)
-                         ||(color_info[0].colorability_class==0b010100))
-                        &&((color_info[1].colorability_class==0b101101) 
-                         ||(color_info[1].colorability_class==0b110011)
-                         ||(color_info[1].colorability_class==0b001010)
-                         ||(color_info[1].colorability_class==0b010100))
-                        &&((color_info[2].colorability_class==0b101101) 
-                         ||(color_info[2].colorability_class==0b110011)
-                         ||(color_info[2].colorability_class==0b001010)
-                         ||(color_info[2].colorability_class==0b010100))
-                       )
-                        printf("this3");
-                    if ((i==3) //&& (cur_color==2) 
-                        &&((color_info[0].colorability_class==0b101101) 
-                         ||(color_info[0].colorability_class==0b110011)
-                         ||(color_info[0].colorability_class==0b001010)
-                         ||(color_info[0].colorability_class==0b010100))
-                        &&((color_info[1].colorability_class==0b101101) 
-                         ||(color_info[1].colorability_class==0b110011)
-                         ||(color_info[1].colorability_class==0b001010)
-                         ||(color_info[1].colorability_class==0b010100))
-                        &&((color_info[2].colorability_class==0b101101) 
-                         ||(color_info[2].colorability_class==0b110011)
-                         ||(color_info[2].colorability_class==0b001010)
-                         ||(color_info[2].colorability_class==0b010100))
-                        &&((color_info[3].colorability_class==0b101101) 
-                         ||(color_info[3].colorability_class==0b110011)
-                         ||(color_info[3].colorability_class==0b001010)
-                         ||(color_info[3].colorability_class==0b010100))
-                       )
-                        printf("this4");
-                    //*/
-                }
-                else
-                {
-                    printf("          ");
-                    for (int k=n+(n/4); k>0; k--)
-                        printf(" ");
-                }
-                if (i<n)
-                    printf("   v=%2d  f[v]=%d  L[v]=%d  needed=%d",
-                        i,f[i],color_info[cur_color].L[i],f[i]-color_info[cur_color].L[i]);
-                printf("\n");
-            }
-            printf(" el_verts=");
-            print_binary(color_info[cur_color].eligible_vertices,n);
-            printf("\n");
-            printf("  el_gens=");
-            print_binary(color_info[cur_color].eligible_generators,n);
-            printf("\n");
-            //*/
+            cancelled=true;
+            return true;  // another engine has decided the graph, or the search was only a probe (see splitlevel_heuristic)
         }
         
+        if ((checkpointer!=NULL) && checkpointer->due(count))
+            save_checkpoint();  // this is the top of the loop, which is where a resumed search starts
+        
+        if ((progress!=NULL) && progress->due(count))
+            progress->report(count);
+        
+        count++;
+        if (cur_color<=splitlevel)
+            shared_count++;
+        statistics.node(cur_color);
+        if (statistics.snapshot_due(count))
+            statistics.write_snapshot();
+        
         
         // When this loop starts, cur_color points to the next colorability class that we will try to generate a subgraph for and add to our list assignment.
         
@@ -458,138 +640,19 @@ bool ListAssignment::verify(int res,int mod,int splitlevel)
             //*/
             
             // We need to check if this partial list assignment is suitable, ie, if there is a feasible coloring.
-            if (!has_feasible_coloring())
+            if ((cur_color==0) && (orbit_pruner!=NULL) && !orbit_pruner->first_in_orbit(color_info[0].colorability_class))
+            {
+                // An image of this colorability class under an automorphism has already been generated on level 0,
+                // so its subtree need not be searched (see automorphism.h).
+                ;  // we go back to the beginning of the loop to generate the next subgraph
+            }
+            else if (!has_feasible_coloring())
             {
                 //printf("We do not have a feasible coloring.\n");
                 
                 // This partial list assignment needs to be advanced.
-                int multiplicity;  // declared outside the loop so it can be used afterward
-                for (multiplicity=__builtin_popcountll(color_info[cur_color].colorability_class); 
-                        // the popcount counts the number of bits set; this is a gcc builtin.
-                     multiplicity>0; multiplicity--)
-                    // we limit the multiplicity of a colorability class to its size
-                {
-                    
-                    //*
-                    // This code allows for parallelization.
-                    if (cur_color==splitlevel)
-                        // we need to check whether we should go further (deepen the search tree) or not
-                    {
-                        // FIXME: TODO:  This break does not allow the search to expand beyond the splitlevel.
-                        // This can be simulated by setting the residue equal to the modulus (and hence no branch is ever expanded).
-                        //break;
-                        
-                        odometer--;
-                        if (odometer<0)
-                            odometer=mod-1;  // reset the odometer
-                        
-                        //printf("v=%d splitlevel=%d odometer=%d residue=%d modulus=%d\n",v,splitlevel,odometer,res,mod);
-                        
-                        if (odometer!=res)  // we will not check this branch
-                        {
-                            // we continue on the level of cur_color with the next colorability class
-                            //printf("cur_color=%d splitlevel=%d odometer=%d residue=%d modulus=%d\n",cur_color,splitlevel,odometer,res,mod);
-                            
-                            // and now we just want to loop again
-                            break;
-                        }
-                        
-                        printf("Odometer tick! cur_color=%d splitlevel=%d odometer=%d residue=%d modulus=%d\n",cur_color,splitlevel,odometer,res,mod);
-                    }
-                    //*/
-                    
-                    color_info[cur_color+1].setup_next_from(color_info[cur_color],f);  // initialize the new colorability_class info
-                    cur_color++;
-                    //printf("next set up, cur_color=%2d\n",cur_color);
-                    
-                    // At this point, this partial list assignment (up through cur_color) does not have a feasible coloring.
-                    // Thus, if this list assignment is full, then this is a bad list assignment and we terminate.
-                    // A list assignment is full if and only if there are no eligible vertices.
-                    // However, the eligible vertices remaining after colorability class cur_color is added is calculated 
-                    // when setting up for the cur_color+1 colorability class.
-                    
-                    /*
-                    printf(">el_verts=");
-                    print_binary(color_info[cur_color].eligible_vertices,n);
-                    printf("\n");
-                    //*/
-                    
-                    if (color_info[cur_color].eligible_vertices==0)
-                    {
-                        cur_color--;  // No colorability class has been assigned to cur_color yet.
-                        
-                        // This is a full list assignment that has no feasible coloring: it's a bad list assignment!
-                        //*/
-                        printf("BAD full list assignment created, cur_color=%d\n",cur_color);
-                        for (int i=0; i<=cur_color; i++)
-                        {
-                            printf("color=%2d  ",i);
-                            print_binary(color_info[i].colorability_class,n);
-                            printf("\n");
-                        }
-                        for (int v=0; v<n; v++)
-                            printf("   v=%2d  f[v]=%d  L[v]=%d  needed=%d\n",
-                                    v,f[v],color_info[cur_color+1].L[v],f[v]-color_info[cur_color+1].L[v]);
-                        printf(" el_verts=");
-                        print_binary(color_info[cur_color+1].eligible_vertices,n);
-                        printf("\n");
-                        printf("  el_gens=");
-                        print_binary(color_info[cur_color+1].eligible_generators,n);
-                        printf("\n");
-                        //*/
-                        
-                        return false;
-                        
-                    }
-                    
-                    // We use the Small Pot Lemma here.
-                    // We currently have cur_color colorability classes in our list assignment.
-                    // If we have at least n-1 colorability classes, then by the Small Pot Lemma we don't need to add an nth one.
-                    // We do this after setting up the next level and calculating eligible_vertices for cur_color+1,
-                    // so that we don't miss a bad full list assignment.
-                    //*
-                    if (cur_color>=n-1)
-                    {
-                        //printf("Applying the Small Pot Lemma! cur_color=%d count=%20llu\n",cur_color,count);
-                        cur_color--;
-                        break;
-                    }
-                    //*/
-                    
-                    /*
-                    printf("incrementing cur_color to %d\n",cur_color);
-                    printf(" colorability_class=");
-                    print_binary(color_info[cur_color].colorability_class,n);
-                    printf("\n");
-                    printf("  eligible_vertices=");
-                    print_binary(color_info[cur_color].eligible_vertices,n);
-                    printf("\n");
-                    //*/
-                    
-                    if ( ( color_info[cur_color].colorability_class & 
-                          ~color_info[cur_color].eligible_vertices) == 0 )
-                        // This subgraph remains eligible, so we'll try to add it again.
-                        // We test if colorability_class is a subset of the eligible vertices.
-                        //     We test if bitarray x is a subset of bitarray y using (x & ~y) == 0.
-                        //     This is just the negation of the implication x=>y.
-                        if (has_feasible_coloring())
-                            break;  // proceed to the next subgraph for this colorability class
-                        else
-                            ;  // we should go back to the beginning of the loop and add this subgraph again
-                    else
-                        break;  // we'll need to find the next subgraph for this colorability class
-                        
-                }
-                
-                //printf("multiplicity=%d\n",multiplicity);
-                
-                if (multiplicity==0)
-                    // This colorability class has multiplicity equal to its size, and so the vertices in the colorability class can always be colored.  Hence we don't need to add any more colors to the lists of those vertices, so we mark them as ineligible.
-                {
-                    //printf("max multiplicity!, cur_color=%d\n",cur_color);
-                    color_info[cur_color].eligible_vertices&=(~color_info[cur_color].colorability_class);
-                }
-                
+                if (!push_colorability_class())
+                    return false;  // a bad list assignment was found
             }
             else  // There is a feasible coloring, so we continue on to the next subgraph.
             {
@@ -597,6 +660,8 @@ bool ListAssignment::verify(int res,int mod,int splitlevel)
                 
                 // We keep track of feasible colorings separately for verifying the parallelization is working correctly.
                 num_feasible_colorings++;
+                if (cur_color<=splitlevel)
+                    shared_feasible_colorings++;
                 
                 ;  // we do nothing and go back to the beginning of the loop to generate the next subgraph
             }
@@ -605,14 +670,472 @@ bool ListAssignment::verify(int res,int mod,int splitlevel)
         {
             // There are no more subgraphs to generate, so we backtrack.
             //printf("Could not generate any more subgraphs\n");
-            cur_color--;
+            pop_colorability_class();
         }
     }
     
-    printf("All list assignments checked, final count=%llu, num_feasible_colorings=%llu\n",count,num_feasible_colorings);
-    // No bad list assignment has been found, so the graph is f-choosable.
     return true;
 }
 
 
+template <typename bitarray_t, typename statistics_t>
+bool ListAssignment<bitarray_t,statistics_t>::push_colorability_class()
+{
+    // The colorability class color_info[cur_color].colorability_class has just been generated, and the partial list assignment has no feasible coloring.
+    // We push it onto the stack, as many times as necessary.
+    // Returns false if a bad list assignment is found, and true otherwise.
+    
+    int level=cur_color;  // the level of the generated colorability class
+    int multiplicity;  // declared outside the loop so it can be used afterward
+    int pushed=0;  // the number of times the class is pushed
+    for (multiplicity=popcount(color_info[cur_color].colorability_class); 
+            // the popcount counts the number of bits set
+         multiplicity>0; multiplicity--)
+        // we limit the multiplicity of a colorability class to its size
+    {
+        
+        //*
+        // This code allows for parallelization.
+        if (cur_color==splitlevel)
+            // we need to check whether we should go further (deepen the search tree) or not
+        {
+            // FIXME: TODO:  This break does not allow the search to expand beyond the splitlevel.
+            // This can be simulated by setting the residue equal to the modulus (and hence no branch is ever expanded).
+            //break;
+            
+            odometer--;
+            if (odometer<0)
+                odometer=mod-1;  // reset the odometer
+            num_split_nodes++;
+            
+            //printf("v=%d splitlevel=%d odometer=%d residue=%d modulus=%d\n",v,splitlevel,odometer,res,mod);
+            
+            if (odometer!=res)  // we will not check this branch
+            {
+                // we continue on the level of cur_color with the next colorability class
+                //printf("cur_color=%d splitlevel=%d odometer=%d residue=%d modulus=%d\n",cur_color,splitlevel,odometer,res,mod);
+                
+                // and now we just want to loop again
+                break;
+            }
+            
+            num_expanded_nodes++;
+            if (out!=NULL)
+                fprintf(out,"Odometer tick! cur_color=%d splitlevel=%d odometer=%d residue=%d modulus=%d\n",cur_color,splitlevel,odometer,res,mod);
+        }
+        //*/
+        
+        color_info[cur_color+1].setup_next_from(color_info[cur_color],f);  // initialize the new colorability_class info
+        cur_color++;
+        pushed++;
+        //printf("next set up, cur_color=%2d\n",cur_color);
+        
+        // At this point, this partial list assignment (up through cur_color) does not have a feasible coloring.
+        // Thus, if this list assignment is full, then this is a bad list assignment and we terminate.
+        // A list assignment is full if and only if there are no eligible vertices.
+        // However, the eligible vertices remaining after colorability class cur_color is added is calculated 
+        // when setting up for the cur_color+1 colorability class.
+        
+        /*
+        printf(">el_verts=");
+        print_binary(color_info[cur_color].eligible_vertices,n);
+        printf("\n");
+        //*/
+        
+        if (color_info[cur_color].eligible_vertices==0)
+        {
+            pop_colorability_class();  // No colorability class has been assigned to cur_color yet.
+            
+            // This is a full list assignment that has no feasible coloring: it's a bad list assignment!
+            if ((pool==NULL) || pool->report_bad_list())  // only the first thread to find one prints it
+                print_bad_list();
+            
+            return false;
+        }
+        
+        // We use the Small Pot Lemma here.
+        // We currently have cur_color colorability classes in our list assignment.
+        // If we have at least n-1 colorability classes, then by the Small Pot Lemma we don't need to add an nth one.
+        // We do this after setting up the next level and calculating eligible_vertices for cur_color+1,
+        // so that we don't miss a bad full list assignment.
+        //*
+        if (cur_color>=n-1)
+        {
+            //printf("Applying the Small Pot Lemma! cur_color=%d count=%20llu\n",cur_color,count);
+            statistics.small_pot_prune(cur_color);
+            pop_colorability_class();
+            break;
+        }
+        //*/
+        
+        /*
+        printf("incrementing cur_color to %d\n",cur_color);
+        printf(" colorability_class=");
+        print_binary(color_info[cur_color].colorability_class,n);
+        printf("\n");
+        printf("  eligible_vertices=");
+        print_binary(color_info[cur_color].eligible_vertices,n);
+        printf("\n");
+        //*/
+        
+        if ( ( color_info[cur_color].colorability_class & 
+              ~color_info[cur_color].eligible_vertices) == 0 )
+            // This subgraph remains eligible, so we'll try to add it again.
+            // We test if colorability_class is a subset of the eligible vertices.
+            //     We test if bitarray x is a subset of bitarray y using (x & ~y) == 0.
+            //     This is just the negation of the implication x=>y.
+            if (has_feasible_coloring())
+                break;  // proceed to the next subgraph for this colorability class
+            else
+                ;  // we should go back to the beginning of the loop and add this subgraph again
+        else
+            break;  // we'll need to find the next subgraph for this colorability class
+            
+    }
+    
+    //printf("multiplicity=%d\n",multiplicity);
+    if (pushed>0)
+        statistics.pushed_class(popcount(color_info[level].colorability_class),pushed);
+    
+    if (multiplicity==0)
+        // This colorability class has multiplicity equal to its size, and so the vertices in the colorability class can always be colored.  Hence we don't need to add any more colors to the lists of those vertices, so we mark them as ineligible.
+    {
+        //printf("max multiplicity!, cur_color=%d\n",cur_color);
+        color_info[cur_color].eligible_vertices&=(~color_info[cur_color].colorability_class);
+    }
+    
+    if ((cur_color>level) && transposition_table.enabled() && transposition_level[cur_color].used && ((mod==-1) || (cur_color>splitlevel)))
+        // The top level is new, and has not generated any subgraphs yet.
+        // With -r/-m, only levels above the splitlevel are searched completely, and skipping them does not change the odometer.
+        check_transposition_table();
+    
+    return true;
+}
+
+
+template <typename bitarray_t, typename statistics_t>
+inline
+void ListAssignment<bitarray_t,statistics_t>::pop_colorability_class()
+{
+    // We backtrack from level cur_color, restoring the subgraph generators to the state the previous level left them in.
+    if (transposition_keyed[cur_color])
+    {
+        // The subtree of this level has been completely searched.
+        transposition_table.insert(transposition_key[cur_color],true);
+        transposition_keyed[cur_color]=false;
+        
+        TranspositionLevel &stats=transposition_level[cur_color];
+        stats.recorded++;
+        stats.nodes+=count-stats.start_count;
+        if ((stats.lookups>=transposition_sample) && (stats.hits*stats.nodes<transposition_min_saving*stats.lookups*stats.recorded))
+            stats.used=false;  // the subtrees skipped are too few or too small
+    }
+    
+    color_info[cur_color].restore_generators();
+    cur_color--;
+    if (cur_color>=0)
+        undo_log.frame=color_info[cur_color].undo_frame;  // changes are again recorded in the previous level's frame
+}
+
+
+template <typename bitarray_t, typename statistics_t>
+double ListAssignment<bitarray_t,statistics_t>::probe(std::mt19937 &random,bool &found_bad_list)
+{
+    // Follows a random path down the search tree from the freshly reset stack, and returns Knuth's estimate of the final count (see estimator.h).
+    // A node of the path is a new level of the stack, and its children are the levels that search would push on top of it:
+    // a level for each generated colorability class without a feasible coloring, and another copy of the class just pushed
+    // if push_colorability_class would push it again.  The count of a node is the number of times generate_subgraph is called on it.
+    // The automorphisms and the transposition table are not used, so this estimates the search without -a and -T.
+    // The stack is left at the end of the path, so it must be reset before it is used again.
+    
+    std::vector<int> children;  // the calls of generate_subgraph at the current level that produce a child
+    double weight=1;  // the product of the numbers of children of the levels above the current one
+    double estimate=0;
+    bitarray_t repeated=0;  // the class of the copies at the top of the stack
+    int num_copies=0;  // the number of copies of repeated just pushed
+    found_bad_list=false;
+    
+    while (true)
+    {
+        ColorabilityClassInfo<bitarray_t> &info=color_info[cur_color];
+        
+        // This is the test at the end of each iteration of the loop in push_colorability_class.
+        bool copy_again=false;  // whether push_colorability_class would push another copy of repeated
+        if ((num_copies>0) && ((repeated & ~info.eligible_vertices)==0) && !has_feasible_coloring())
+        {
+            if (num_copies<popcount(repeated))
+                copy_again=true;
+            else
+                info.eligible_vertices&=(~repeated);  // repeated has multiplicity equal to its size
+        }
+        
+        bitarray_t eligible_vertices=info.eligible_vertices;
+        bitarray_t eligible_generators=info.eligible_generators;
+        int num_calls=0;
+        children.clear();
+        while (true)
+        {
+            num_calls++;
+            if (!info.generate_subgraph())
+                break;
+            if (!has_feasible_coloring())
+                children.push_back(num_calls);
+        }
+        
+        estimate+=weight*num_calls;
+        int num_children=children.size()+copy_again;
+        if (num_children==0)
+            break;
+        weight*=num_children;
+        
+        // The generators are put back to the start of the level, and the chosen child is generated again.
+        int choice=std::uniform_int_distribution<int>(0,num_children-1)(random);
+        info.restore_generators();
+        info.eligible_vertices=eligible_vertices;
+        info.eligible_generators=eligible_generators;
+        if (choice<(int)children.size())
+        {
+            for (int i=children[choice]; i>0; i--)
+                info.generate_subgraph();
+            repeated=info.colorability_class;
+            num_copies=0;
+        }
+        else
+            info.colorability_class=repeated;
+        
+        color_info[cur_color+1].setup_next_from(info,f);
+        cur_color++;
+        num_copies++;
+        
+        if (color_info[cur_color].eligible_vertices==0)
+        {
+            pop_colorability_class();
+            found_bad_list=true;  // the stack is left at the bad list assignment for print_bad_list
+            break;
+        }
+        if (cur_color>=n-1)
+            break;  // the Small Pot Lemma
+    }
+    
+    return estimate;
+}
+
+
+template <typename bitarray_t, typename statistics_t>
+void ListAssignment<bitarray_t,statistics_t>::make_transposition_key(std::vector<bitarray_t> &key) const
+{
+    // The key holds the number of levels below cur_color, the sorted colorability classes of those levels,
+    // the eligible vertices and generators of cur_color, and then for each eligible generator its eligible vertices and layers.
+    // The L values are determined by the colorability classes, and the generators that are not eligible are never used again.
+    key.clear();
+    key.push_back(cur_color);
+    for (int i=0; i<cur_color; i++)
+        key.push_back(color_info[i].colorability_class);
+    std::sort(key.begin()+1,key.end());
+    
+    const ColorabilityClassInfo<bitarray_t> &info=color_info[cur_color];
+    key.push_back(info.eligible_vertices);
+    key.push_back(info.eligible_generators);
+    for (bitarray_t x=info.eligible_generators; x!=0; x&=x-1)
+    {
+        const ConnectedSubgraph<bitarray_t> &S=generator[lowest_bit(x)];
+        key.push_back(S.eligible_vertices);
+        key.push_back(S.cur_layer);
+        for (int i=0; i<=S.cur_layer; i++)
+        {
+            key.push_back(S.layer[i].layer_subset);
+            key.push_back(S.layer[i].layer_universe);
+        }
+    }
+}
+
+
+template <typename bitarray_t, typename statistics_t>
+bool ListAssignment<bitarray_t,statistics_t>::check_transposition_table()
+{
+    // Called when cur_color is a new level.
+    // If its subtree has already been searched, we backtrack and return true.
+    // Otherwise we remember the key, so that the subtree can be recorded when we backtrack from it.
+    // Making a key costs as much as searching several nodes, and on most levels the subtrees are small or rarely repeated,
+    // so a level stops using the table once it has been seen to save less than transposition_min_saving nodes per lookup,
+    // estimating the nodes saved by a hit as the mean count of the subtrees recorded on the level.
+    TranspositionLevel &stats=transposition_level[cur_color];
+    stats.lookups++;
+    make_transposition_key(transposition_key[cur_color]);
+    
+    bool value;
+    if (transposition_table.lookup(transposition_key[cur_color],value))
+    {
+        stats.hits++;
+        pop_colorability_class();
+        return true;
+    }
+    
+    stats.start_count=count;
+    transposition_keyed[cur_color]=true;
+    return false;
+}
+
+
+template <typename bitarray_t, typename statistics_t>
+bitarray_t ListAssignment<bitarray_t,statistics_t>::input_labels(bitarray_t x) const
+{
+    // Moves the bit of each vertex in x to the bit of its input label.
+    if (labels==NULL)
+        return x;
+    
+    bitarray_t y=0;
+    for (int v=0; v<n; v++)
+        if (x & ((bitarray_t)1<<v))
+            y|=(bitarray_t)1<<(*labels)[v];
+    return y;
+}
+
+
+template <typename bitarray_t, typename statistics_t>
+void ListAssignment<bitarray_t,statistics_t>::print_bad_list() const
+{
+    // This is called when the stack holds a full list assignment without a feasible coloring.
+    // The colorability classes are 0..cur_color, and the L values are on the next level.
+    // With labels, everything is printed with the input labels of the vertices.
+    if (out==NULL)
+        return;
+    
+    std::vector<int> vertex(n);  // the vertex with each input label
+    for (int v=0; v<n; v++)
+        vertex[(labels!=NULL) ? (*labels)[v] : v]=v;
+    
+    fprintf(out,"BAD full list assignment created, cur_color=%d\n",cur_color);
+    for (int i=0; i<=cur_color; i++)
+    {
+        fprintf(out,"color=%2d  ",i);
+        print_binary(input_labels(color_info[i].colorability_class),n,out);
+        fprintf(out,"\n");
+    }
+    for (int u=0; u<n; u++)
+    {
+        int v=vertex[u];
+        fprintf(out,"   v=%2d  f[v]=%d  L[v]=%d  needed=%d\n",
+                u,f[v],color_info[cur_color+1].L[v],f[v]-color_info[cur_color+1].L[v]);
+    }
+    fprintf(out," el_verts=");
+    print_binary(input_labels(color_info[cur_color+1].eligible_vertices),n,out);
+    fprintf(out,"\n");
+    fprintf(out,"  el_gens=");
+    print_binary(input_labels(color_info[cur_color+1].eligible_generators),n,out);
+    fprintf(out,"\n");
+}
+
+
+template <typename bitarray_t, typename statistics_t>
+void ListAssignment<bitarray_t,statistics_t>::donate_base_level()
+{
+    // We give the continuation of level base_color to the task pool, so that an idle thread can search it.
+    // The level is left exactly as the main loop would find it when backtracking to it, so we only need to copy it.
+    SearchTask<bitarray_t> *task=new SearchTask<bitarray_t>(n,neighbors,neighborhood);
+    
+    task->level=base_color;
+    task->colorability_class.resize(base_color);
+    for (int i=base_color-1; i>=0; i--)
+        task->colorability_class[i]=color_info[i].colorability_class;
+    task->info.copy_from(color_info[base_color]);
+    
+    // The generators are shared by all levels, so we undo the changes made by the levels above base_color in a copy of them.
+    for (int i=n-1; i>=0; i--)
+        task->generator[i].copy_from(generator[i]);
+    undo_log.restore(task->generator,color_info[base_color+1].undo_mark);
+    
+    base_color++;  // this thread no longer searches that level
+    pool->donate(thread_id,task);
+}
+
+
+template <typename bitarray_t, typename statistics_t>
+void ListAssignment<bitarray_t,statistics_t>::load_task(const SearchTask<bitarray_t> &task)
+{
+    // We set up the stack to continue the search at level task.level.
+    for (int i=task.level-1; i>=0; i--)
+        color_info[i].colorability_class=task.colorability_class[i];
+    color_info[task.level].copy_from(task.info);
+    
+    undo_log.clear();
+    for (int i=n-1; i>=0; i--)
+    {
+        generator[i].copy_from(task.generator[i]);
+        generator[i].undo_frame=0;  // not saved in any frame of our log
+    }
+    color_info[task.level].undo_mark=0;
+    color_info[task.level].undo_frame=undo_log.frame;
+    for (int i=task.level-1; i>=0; i--)
+        color_info[i].undo_frame=undo_log.frame;
+            // the levels below are not searched, but the Hall filter and the witness pool take their frames to identify their classes,
+            // so frames left from a previous task must not match
+    
+    // The key of task.level is not known, since it was new in another thread.
+    for (size_t i=0; i<transposition_keyed.size(); i++)
+        transposition_keyed[i]=false;
+    
+    cur_color=task.level;
+    base_color=task.level;
+}
+
+
+template <typename bitarray_t, typename statistics_t>
+void ListAssignment<bitarray_t,statistics_t>::save_checkpoint()
+{
+    // Each level of the stack is saved as a task, in the same way as donate_base_level.
+    // The levels below base_color are the tasks that we resumed from, which are continued later.
+    CheckpointState<bitarray_t> state;
+    state.count=count;
+    state.num_feasible_colorings=num_feasible_colorings;
+    state.odometer=odometer;
+    
+    for (int level=0; level<base_color; level++)
+        state.tasks.push_back(resumed_tasks[level]);
+    
+    std::vector<ConnectedSubgraph<bitarray_t> > saved_generator(generator);
+    for (int level=cur_color; level>=base_color; level--)
+    {
+        SearchTask<bitarray_t> *task=new SearchTask<bitarray_t>(n,neighbors,neighborhood);
+        task->level=level;
+        task->colorability_class.resize(level);
+        for (int i=level-1; i>=0; i--)
+            task->colorability_class[i]=color_info[i].colorability_class;
+        task->info.copy_from(color_info[level]);
+        
+        if (level<cur_color)
+            undo_log.restore(saved_generator,color_info[level+1].undo_mark);
+        for (int i=n-1; i>=0; i--)
+            task->generator[i].copy_from(saved_generator[i]);
+        
+        state.tasks.insert(state.tasks.begin()+base_color,task);
+    }
+    
+    if (orbit_pruner!=NULL)
+    {
+        std::lock_guard<std::mutex> guard(orbit_pruner->lock);
+        state.has_orbits=true;
+        state.orbits_searched=orbit_pruner->num_searched;
+        state.orbits_skipped=orbit_pruner->num_skipped;
+        state.orbits_seen.assign(orbit_pruner->seen.begin(),orbit_pruner->seen.end());
+    }
+    
+    if (write_checkpoint(*checkpointer,state,n))
+        fprintf(out,"Checkpoint written to %s, count=%llu\n",checkpointer->filename.c_str(),count);
+    else
+        fprintf(out,"Could not write checkpoint to %s!\n",checkpointer->filename.c_str());
+    fflush(out);
+    
+    for (int level=0; level<base_color; level++)
+        state.tasks[level]=NULL;  // these are still owned by the state we resumed from
+    
+    if (checkpointer->stop_requested())
+    {
+        fprintf(out,"Stopping the search, as requested by a signal.\n");
+        exit(10);
+    }
+    checkpointer->written();
+}
+
+
 #endif  // LISTASSIGNMENT_H__HOLJNEPCVXFOXMPEAIHG
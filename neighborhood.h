@@ -0,0 +1,99 @@
+
+// neighborhood.h
+// This is a C++ library for quickly computing the union of the neighborhoods of a set of vertices.
+// The library is contained in one header file to enable use of inline functions.
+
+// Copyright 2017, Stephen G. Hartke
+// Licensed under the GPL version 3.
+
+
+#pragma once  // for compilers that support this
+#ifndef NEIGHBORHOOD_H__AHZOOQUEIVAETHOOSHIE  // include guard
+#define NEIGHBORHOOD_H__AHZOOQUEIVAETHOOSHIE
+
+
+#include <vector>
+#include "bitarray.h"
+
+
+/* Computing the next layer of a connected subgraph requires the union of the neighborhoods of the vertices in a layer.
+ * Scanning all n vertices with a mask is slow, especially since layers usually have only a few vertices.
+ * Instead, we precompute for each byte of the bitarray a table of 256 entries,
+ * where entry x is the union of the neighborhoods of the vertices whose bits are set in x.
+ * A union is then ceil(n/8) table lookups.
+ * If the set has fewer vertices than that, we instead iterate over its bits.
+ */
+
+
+template <typename bitarray_t>
+class NeighborhoodTable
+{
+public:
+    int n;  // number of vertices in the whole graph
+    const std::vector<bitarray_t> &neighbors;  // adjacencies in the graph
+    int num_bytes;  // the number of bytes needed to hold n bits
+    std::vector<bitarray_t> byte_union;  // entry 256*b+x is the union of the neighborhoods of the vertices in byte b of x
+    
+    NeighborhoodTable(int n, const std::vector<bitarray_t> &neighbors);
+    
+    void compute(int n);
+    bitarray_t neighborhood(const bitarray_t &S) const;
+};
+
+
+template <typename bitarray_t>
+NeighborhoodTable<bitarray_t>::NeighborhoodTable(int n, const std::vector<bitarray_t> &neighbors)
+  : // initializer list
+    neighbors(neighbors)
+{
+    compute(n);
+}
+
+
+template <typename bitarray_t>
+void NeighborhoodTable<bitarray_t>::compute(int n)
+    // Fills in the table from neighbors, which has n entries.  This is also used when neighbors has been changed to another graph.
+{
+    this->n=n;
+    num_bytes=(n+7)/8;
+    byte_union.resize(256*num_bytes);
+    
+    for (int b=0; b<num_bytes; b++)
+    {
+        byte_union[256*b]=0;
+        for (int x=1; x<256; x++)
+        {
+            // x with its lowest bit removed has already been computed
+            int v=8*b+__builtin_ctz(x);
+            byte_union[256*b+x]=byte_union[256*b+(x&(x-1))];
+            if (v<n)
+                byte_union[256*b+x]|=neighbors[v];
+        }
+    }
+}
+
+
+template <typename bitarray_t>
+inline
+bitarray_t NeighborhoodTable<bitarray_t>::neighborhood(const bitarray_t &S) const
+    // Returns the union of the neighborhoods of the vertices in S.
+{
+    bitarray_t result=0;
+    
+    if (popcount(S)<num_bytes)
+    {
+        // S is sparse, so we iterate over its vertices.
+        for (bitarray_t x=S; x!=0; x&=x-1)
+            result|=neighbors[lowest_bit(x)];
+    }
+    else
+    {
+        for (int b=num_bytes-1; b>=0; b--)
+            result|=byte_union[256*b+get_byte(S,b)];
+    }
+    
+    return result;
+}
+
+
+#endif  // NEIGHBORHOOD_H__AHZOOQUEIVAETHOOSHIE
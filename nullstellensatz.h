@@ -0,0 +1,558 @@
+
+// nullstellensatz.h
+// This is a C++ library for proving that a graph is f-choosable with the Combinatorial Nullstellensatz.
+// The library is contained in one header file to enable use of inline functions.
+
+// Copyright 2017, Stephen G. Hartke
+// Licensed under the GPL version 3.
+
+
+#pragma once  // for compilers that support this
+#ifndef NULLSTELLENSATZ_H__AHQUEIGHEEJOOTHOHKAE  // include guard
+#define NULLSTELLENSATZ_H__AHQUEIGHEEJOOTHOHKAE
+
+
+#include <string>
+#include <cstdio>  // for printf
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>  // for the time budget
+#include <climits>  // for ULLONG_MAX
+#include "fgraph.h"
+#include "compositions.h"
+#include "graphpolynomial.h"
+#include "alontarsi.h"
+#include "boundedcache.h"
+
+extern "C" 
+{
+    #include "exact.h"  // libexact is a C library, not C++
+}
+
+
+
+enum CoefficientEngine { ENGINE_LIBEXACT, ENGINE_DP, ENGINE_MODP, ENGINE_CHECK, ENGINE_ALONTARSI };
+
+const unsigned long long int coefficient_prime=(1ULL<<61)-1;  // a Mersenne prime, used by ENGINE_MODP
+
+
+struct CheckOptions
+    // The options that determine how each graph is checked.
+{
+    int num_threads;
+    CoefficientEngine engine;
+    int cache_size;
+    unsigned long long int max_compositions;  // the number of compositions to check before giving up; 0 for no limit
+    double max_seconds;  // likewise for the wall clock time of the composition search
+    const std::atomic<bool> *cancel;  // stops the composition search when set by another thread; NULL if not used
+};
+
+
+struct CompositionBudget
+    // Decides when the search of the compositions gives up (see CheckOptions), which makes the Nullstellensatz inconclusive.
+{
+    const CheckOptions &options;
+    std::chrono::steady_clock::time_point start;
+    
+    CompositionBudget(const CheckOptions &options);
+    
+    bool exhausted(unsigned long long int num_checked) const;
+};
+
+
+CompositionBudget::CompositionBudget(const CheckOptions &options)
+  : // initializer list
+    options(options),
+    start(std::chrono::steady_clock::now())
+{
+}
+
+
+bool CompositionBudget::exhausted(unsigned long long int num_checked) const
+    // num_checked is the number of compositions checked so far.
+    // The clock and cancel are only read every 64 compositions, since most compositions take less time than reading the clock.
+{
+    if ((options.max_compositions>0) && (num_checked>=options.max_compositions))
+        return true;
+    if ((num_checked&63)!=0)
+        return false;
+    if ((options.cancel!=NULL) && options.cancel->load(std::memory_order_relaxed))
+        return true;
+    if (options.max_seconds>0)
+        return (std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count()>=options.max_seconds);
+    return false;
+}
+
+
+// Different compositions often reduce to the same graph after removing the vertices with f[i]==1,
+// so we cache the leading coefficients by the fgraph6 string of the reduced graph.
+typedef BoundedCache<std::string,coefficient_t,std::hash<std::string> > CoefficientCache;
+
+
+coefficient_t leading_coefficient_libexact(const fGraph& G)
+    // We assume that sum(G.f[i]-1)==G.num_edges, 
+    // and that G.f[i]>=2 for all i.
+{
+    // for libexact
+    exact_t *e;
+    int soln_size;
+    const int *soln;
+    
+    int n,num_edges;
+    coefficient_t coeff;  // the number of solutions can exceed the range of an int
+    int sign;
+    //int count;
+    int i,j,k;
+    
+    n=G.n;
+    num_edges=G.get_number_of_edges();
+    
+    if ((n<=1) || (num_edges==0))
+    {
+        printf("PROBLEM: n=%d num_edges=%d\n",n,num_edges);
+        exit(7);
+    }
+    
+    // Initialize the exact cover library.
+    e=exact_alloc();
+    
+    // In the exact cover problem, we have 2 columns for each edge (whether x_i or -x_j is chosen from the factor corresponding to the edge v_i v_j).
+    for (j=0; j<2*num_edges; j++)
+        exact_declare_col(e,j,1);
+    
+    // We also have n+e rows:
+    // The first n rows are the computation of the degree of the monomial.
+    for (i=0; i<n; i++)
+        exact_declare_row(e,i,G.f[i]-1);
+    
+    // The last e edges are ensuring exactly 1 term is chosen from each factor.
+    for ( ; i<n+num_edges; i++)
+        exact_declare_row(e,i,1);
+    
+    // Loop over the edges of G to set the matrix.
+    k=0;  // index of this edge
+    for (j=0; j<n; j++)
+        for (i=0; i<j; i++)
+            if (G.get_adj_sorted(i,j))  // i,j is an edge
+            {
+                // mark the contributions to x_i and x_j
+                exact_declare_entry(e,i,2*k);
+                exact_declare_entry(e,j,2*k+1);
+                
+                // ensure that exactly one term is chosen from each factor
+                exact_declare_entry(e,n+k,2*k);
+                exact_declare_entry(e,n+k,2*k+1);
+                k++;
+            }
+    
+    //count=0;
+    coeff=0;
+    while ((soln=exact_solve(e,&soln_size)) !=NULL)
+    {
+        sign=0;  // (-1)^sign is the contribution we will add to coeff
+        for (i=soln_size-1; i>=0; i--)
+            sign^=(soln[i]&1);  // the odd-indexed cols have negative sign; we want the parity of those
+                // sign is thus 0 or 1 at all times
+        coeff+=(1-2*sign);
+        //count+=1;
+    }
+    //printf("count=%d\n",count);
+    
+    exact_free(e);
+    
+    return coeff;
+}
+
+
+coefficient_t leading_coefficient(const fGraph& G,CoefficientEngine engine)
+    // We assume that sum(G.f[i]-1)==G.num_edges, 
+    // and that G.f[i]>=2 for all i.
+    // With ENGINE_MODP, this returns the residue of the coefficient modulo coefficient_prime.
+{
+    if (engine==ENGINE_LIBEXACT)
+        return leading_coefficient_libexact(G);
+    
+    GraphPolynomial polynomial(G);
+    if (engine==ENGINE_MODP)
+        return polynomial.coefficient_mod(coefficient_prime);
+    
+    coefficient_t coeff=polynomial.coefficient();
+    if (engine==ENGINE_CHECK)
+    {
+        coefficient_t coeff_libexact=leading_coefficient_libexact(G);
+        if (coeff!=coeff_libexact)
+        {
+            printf("MISMATCH: the coefficient is %s with libexact and %s with dp.\n",
+                   coefficient_to_string(coeff_libexact).c_str(),coefficient_to_string(coeff).c_str());
+            G.print_adj_matrix();
+            exit(7);
+        }
+    }
+    return coeff;
+}
+
+
+void print_coefficient(coefficient_t coeff,CoefficientEngine engine,FILE *out)
+{
+    fprintf(out,"  coeff=%2s%s  <---------\n",coefficient_to_string(coeff).c_str(),(engine==ENGINE_MODP) ? " (mod 2^61-1)" : "");
+}
+
+
+void print_cache_counts(unsigned long long int hits,unsigned long long int misses,FILE *out)
+{
+    fprintf(out,"  Coefficient cache: hits=%llu misses=%llu hit rate=%.1f%%\n",
+            hits,misses,(hits+misses>0) ? (100.0*hits)/(hits+misses) : 0.0);
+}
+
+
+bool composition_succeeds(const fGraph& G,const std::vector<int> &x,fGraph &H,CoefficientEngine engine,CoefficientCache &cache,
+                          coefficient_t &coeff)
+    // We test if the Combinatorial Nullstellensatz proves that G is f-choosable, using G's f vector minus the composition x.
+    // H is used for the computation.  coeff is set to the leading coefficient, or to 0 if it was not needed.
+{
+    int condition_of_H;  // return value of H->remove_vertices_with_f_1()
+    
+    coeff=0;
+    if (G.words_per_row<=1)
+        condition_of_H=H.copy_with_vertices_with_f_1_removed(G,x);
+    else
+    {
+        // reset the adjacencies in H, in case they were changed when removing vertices with f[i]==1
+        H.copy_from(G);
+        
+        // set H's f vector to be G's f vector minus the composition
+        for (int i=G.n-1; i>=0; i--)
+            H.f[i]= G.f[i] - x[i];
+        
+        condition_of_H=H.remove_vertices_with_f_1();
+    }
+    if (condition_of_H==2)
+        return true;
+    if (condition_of_H==1)  // f[i]>=2 for all i, so we can call leading_coefficient
+    {
+        if (!cache.enabled())
+            coeff=leading_coefficient(H,engine);
+        else
+        {
+            std::string key=H.write_fgraph6_string();  // H has been compressed, so only its remaining vertices are in the key
+            if (!cache.lookup(key,coeff))
+            {
+                coeff=leading_coefficient(H,engine);
+                cache.insert(key,coeff);
+            }
+        }
+        return (coeff!=0);
+    }
+    return false;
+}
+
+
+struct CompositionChunks
+    // The compositions are dealt out to the threads in chunks of consecutive compositions.
+    // To give the same output as a single thread, we find the first composition in colex order that succeeds.
+    // Hence once a composition succeeds, the threads skip every later composition, but still check the earlier ones.
+    // The budget is checked whenever a chunk is dealt out, so a limit on the number of compositions is rounded up to whole chunks.
+{
+    static const int chunk_size=64;
+    
+    std::mutex lock;  // protects everything below except found_index, which is read without it
+    Compositions next;  // the first composition of the next chunk
+    bool remaining;  // whether next has not been dealt out yet
+    unsigned long long int next_index;  // the position of next in colex order
+    std::atomic<unsigned long long int> found_index;  // the position of the first composition known to succeed; ULLONG_MAX if none
+    std::vector<int> found_x;
+    coefficient_t found_coeff;
+    unsigned long long int cache_hits, cache_misses;  // the totals of the threads' caches
+    CompositionBudget budget;
+    bool stopped;  // whether the budget ran out before all of the compositions were dealt out
+    
+    CompositionChunks(int diff,int n,const CheckOptions &options);
+    
+    bool get_chunk(Compositions &C,unsigned long long int &index);
+    void found(const Compositions &C,unsigned long long int index,coefficient_t coeff);
+    void work(const fGraph& G,const CheckOptions &options,CoefficientCache &cache);
+    void work_with_own_cache(const fGraph& G,const CheckOptions &options);
+};
+
+
+CompositionChunks::CompositionChunks(int diff,int n,const CheckOptions &options)
+  : // initializer list
+    remaining(true),
+    next_index(0),
+    found_index(ULLONG_MAX),
+    found_coeff(0),
+    cache_hits(0),
+    cache_misses(0),
+    budget(options),
+    stopped(false)
+{
+    next.first(diff,n);
+}
+
+
+bool CompositionChunks::get_chunk(Compositions &C,unsigned long long int &index)
+    // Sets C to the first composition of the next chunk, which is at position index.
+    // Returns false if there are no more compositions, or if they all come after one that succeeds, or if the budget has run out.
+{
+    std::lock_guard<std::mutex> guard(lock);
+    if (!remaining || (next_index>=found_index.load()))
+        return false;
+    if (budget.exhausted(next_index))
+    {
+        stopped=true;
+        return false;
+    }
+    
+    C=next;
+    index=next_index;
+    for (int k=chunk_size; k>0; k--)
+    {
+        if (!next.next())
+        {
+            remaining=false;
+            break;
+        }
+        next_index++;
+    }
+    return true;
+}
+
+
+void CompositionChunks::found(const Compositions &C,unsigned long long int index,coefficient_t coeff)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    if (index<found_index.load())
+    {
+        found_index=index;
+        found_x=C.x;
+        found_coeff=coeff;
+    }
+}
+
+
+void CompositionChunks::work(const fGraph& G,const CheckOptions &options,CoefficientCache &cache)
+    // Run by each thread, until there are no more chunks to check.
+{
+    fGraph H;  // each thread has its own
+    Compositions C;
+    unsigned long long int index;
+    coefficient_t coeff;
+    unsigned long long int initial_hits=cache.hits, initial_misses=cache.misses;
+    
+    while (get_chunk(C,index))
+        for (int k=chunk_size; (k>0) && (index<found_index.load()); k--, index++)
+        {
+            if (composition_succeeds(G,C.x,H,options.engine,cache,coeff))
+            {
+                found(C,index,coeff);
+                break;  // the rest of the chunk comes later in colex order
+            }
+            if (!C.next())
+                break;  // this was the last composition
+        }
+    
+    std::lock_guard<std::mutex> guard(lock);
+    cache_hits+=cache.hits-initial_hits;
+    cache_misses+=cache.misses-initial_misses;
+}
+
+
+void CompositionChunks::work_with_own_cache(const fGraph& G,const CheckOptions &options)
+    // The helper threads only live for one graph, so their caches do too.
+{
+    CoefficientCache cache;
+    cache.max_entries=options.cache_size;
+    work(G,options,cache);
+}
+
+
+bool is_fchoosable_with_threads(const fGraph& G,int diff,const CheckOptions &options,CoefficientCache &cache,
+                                std::vector<int> &x,coefficient_t &coeff,unsigned long long int &num_checked,FILE *out)
+    // We check the compositions of diff into G.n parts using options.num_threads threads, including this one.
+    // If one succeeds, we set x to the first one in colex order, and coeff to its leading coefficient, and return true.
+    // Otherwise num_checked is set to the number of compositions dealt out if the budget ran out, and to 0 if not.
+    // This thread uses cache, and the others use their own.
+{
+    CompositionChunks chunks(diff,G.n,options);
+    std::vector<std::thread> threads;
+    
+    for (int t=1; t<options.num_threads; t++)
+        threads.push_back(std::thread(&CompositionChunks::work_with_own_cache,&chunks,std::cref(G),std::cref(options)));
+    chunks.work(G,options,cache);
+    for (size_t t=0; t<threads.size(); t++)
+        threads[t].join();
+    
+    if (cache.enabled())
+        print_cache_counts(chunks.cache_hits,chunks.cache_misses,out);
+    
+    if (chunks.found_index.load()==ULLONG_MAX)
+    {
+        num_checked=chunks.stopped ? chunks.next_index : 0;
+        return false;
+    }
+    x=chunks.found_x;
+    coeff=chunks.found_coeff;
+    return true;
+}
+
+
+int is_fchoosable_alon_tarsi(const fGraph& G,FILE *out)
+    // We search for an Alon-Tarsi orientation of G, which proves that G is f-choosable.
+    // The returned values are the same as for is_fchoosable_nullstellensatz.
+{
+    int i;
+    
+    if (G.n>(int)(8*sizeof(bitarray)))
+    {
+        fprintf(out,"The graph has more than %d vertices, which is too many for the Alon-Tarsi engine.\n",(int)(8*sizeof(bitarray)));
+        return 2;
+    }
+    
+    AlonTarsi alon_tarsi(G);
+    bool success=alon_tarsi.search();
+    fprintf(out,"  Outdegree sequences checked: %llu\n",alon_tarsi.num_outdegree_sequences);
+    if (!success)
+        return 2;  // the Combin Nullst is inconclusive
+    
+    fprintf(out,"  even-odd=%2s  <---------\n",coefficient_to_string(alon_tarsi.difference).c_str());
+    fprintf(out,"Success! <===============================================================================\n");
+    fprintf(out,"  f(H)=");
+    for (i=0; i<G.n-1; i++)
+        fprintf(out,"%d,",alon_tarsi.outdegree[i]+1);
+    fprintf(out,"%d\n",alon_tarsi.outdegree[G.n-1]+1);
+    
+    return 1;  // G is proved to be f-choosable by the Combin Nullst.
+}
+
+
+int composition_total(const fGraph& G)
+    // The compositions that are subtracted from f are of sum(f[i]-1)-num_edges.
+    // If this is negative, then the Nullstellensatz cannot be used.
+{
+    int sum_f_minus_1=0;
+    for (int i=G.n-1; i>=0; i--)
+        sum_f_minus_1+=(G.f[i]-1);
+    return sum_f_minus_1-G.get_number_of_edges();
+}
+
+
+int is_fchoosable_nullstellensatz(const fGraph& G,const CheckOptions &options,FILE *out)
+    // We test if an fgraph is f-choosable, and report to out.
+    // A returned value of 1 means that we can prove using the Combinatorial Nullstellensatz that G is f-choosable.
+    // Other returned values means that such a proof fails.
+    // In particular, 4 means that the search of the compositions gave up, because of the budget in options or because it was cancelled.
+{
+    int diff;
+    int i;
+    coefficient_t coeff;
+    thread_local fGraph H;  // kept by each thread, so that its memory is reused for the following graphs
+    thread_local CoefficientCache cache;  // likewise, and its entries are useful for the following graphs too
+    Compositions C;
+    
+    cache.max_entries=options.cache_size;
+    unsigned long long int initial_hits=cache.hits, initial_misses=cache.misses;
+    
+    
+    for (i=G.n-1; i>=0; i--)
+        if (G.f[i]<=0)
+        {
+            fprintf(out,"f[%d]=%d<=0, which means the graph is not f-choosable.\n",i,G.f[i]);
+            return 0;
+        }
+    
+    diff=composition_total(G);
+    
+    //printf("diff=%d\n",diff);
+    
+    if (diff<0)
+    {
+        fprintf(out,"sum(f[i]-1)<num_edges, so the Nullstellensatz cannot be used.\n");
+        return 3;
+    }
+    
+    if (options.engine==ENGINE_ALONTARSI)
+        return is_fchoosable_alon_tarsi(G,out);
+    else if (diff==0)
+    {
+        C.first(0,G.n);  // the only composition is all 0s
+        bool success=composition_succeeds(G,C.x,H,options.engine,cache,coeff);
+        if (cache.enabled())
+            print_cache_counts(cache.hits-initial_hits,cache.misses-initial_misses,out);
+        if (success)
+        {
+            if (coeff!=0)
+                print_coefficient(coeff,options.engine,out);
+            fprintf(out,"Success! <===============================================================================\n");
+            fprintf(out,"  f(G)=");
+            for (i=0; i<G.n-1; i++)
+                fprintf(out,"%d,",G.f[i]);
+            fprintf(out,"%d\n",G.f[G.n-1]);
+            
+            return 1;  // G is proved to be f-choosable by the Combin Nullst.
+        }
+        else
+            return 2;  // the Combin Nullst is inconclusive
+    }
+    // else if (diff>0)
+    
+    bool success=false;
+    unsigned long long int num_checked=0;  // only counted when the budget runs out with threads
+    bool stopped=false;
+    if (options.num_threads>1)
+    {
+        success=is_fchoosable_with_threads(G,diff,options,cache,C.x,coeff,num_checked,out);
+        stopped=(num_checked>0);
+    }
+    else
+    {
+        CompositionBudget budget(options);
+        C.first(diff,G.n);  // initialize the compositions; we know that diff>0
+        do  // iterate over all compositions
+        {
+            if (budget.exhausted(num_checked))
+            {
+                stopped=true;
+                break;
+            }
+            num_checked++;
+            
+            /*
+            printf("C->x: ");
+            for (i=0; i<G.n; i++)
+               printf("%d ",C->x[i]);
+            printf("\n");
+            //*/
+            
+            success=composition_succeeds(G,C.x,H,options.engine,cache,coeff);
+        } while (!success && C.next());
+        
+        if (cache.enabled())
+            print_cache_counts(cache.hits-initial_hits,cache.misses-initial_misses,out);
+    }
+    
+    if (success)
+    {
+        if (coeff!=0)
+            print_coefficient(coeff,options.engine,out);
+        fprintf(out,"Success! <===============================================================================\n");
+        fprintf(out,"  f(H)=");
+        for (i=0; i<G.n; i++)
+            fprintf(out,"%d,",G.f[i]-C.x[i]);  // H.f[i] might have been modified when removing vertices with f[i]==1
+        fprintf(out,"%d\n",G.f[G.n-1]-C.x[G.n-1]);
+        
+        return 1;  // G is proved to be f-choosable by the Combin Nullst.
+    }
+    
+    if (stopped)
+    {
+        fprintf(out,"  The composition search gave up after %llu compositions.\n",num_checked);
+        return 4;  // inconclusive, but the remaining compositions might succeed
+    }
+    
+    return 2;  // the Combin Nullst is inconclusive
+}
+
+
+#endif  // NULLSTELLENSATZ_H__AHQUEIGHEEJOOTHOHKAE
@@ -0,0 +1,153 @@
+
+// ordering.h
+// This is a C++ library for choosing an order of the vertices of an fgraph before the exhaustive search.
+// The library is contained in one header file to enable use of inline functions.
+
+// Copyright 2017, Stephen G. Hartke
+// Licensed under the GPL version 3.
+
+
+#pragma once  // for compilers that support this
+#ifndef ORDERING_H__CHOOXAIPHEEVAEGHAIWO  // include guard
+#define ORDERING_H__CHOOXAIPHEEVAEGHAIWO
+
+
+#include <vector>
+#include <algorithm>  // for reverse and stable_sort
+#include "fgraph.h"
+
+
+/* The exhaustive search depends on the order of the vertices in several places: find_feasible_coloring colors the vertices
+ * in the order 0..n-1 and only checks the previous neighbors of each vertex, every subgraph generator only uses vertices
+ * up to its root, and generate_subgraph breaks ties between vertices by taking the highest.  The order of the input is arbitrary,
+ * and the running time can change by more than 10 times with the order, so the fgraph can be relabeled before it is searched.
+ *
+ * Each ordering is given as order, where new vertex i is vertex order[i] of the input.
+ *     degeneracy  repeatedly removes a vertex of minimum degree, and numbers the vertices in the reverse of the order of removal,
+ *                 so that each vertex has at most the degeneracy of the graph previous neighbors;
+ *     bfs         is a breadth first search from the vertex with the highest f (and then the highest degree),
+ *                 so that the neighbors of each vertex are close to it;
+ *     bandwidth   is the reverse Cuthill-McKee ordering, which is a heuristic for a small bandwidth,
+ *                 since finding the minimum bandwidth is NP-hard.
+ * Disconnected graphs continue each ordering from the best remaining vertex.
+ */
+
+
+enum VertexOrdering { ORDER_INPUT, ORDER_DEGENERACY, ORDER_BFS, ORDER_BANDWIDTH, ORDER_AUTO };
+const int num_vertex_orderings=4;  // the orderings before ORDER_AUTO, which chooses one of them
+
+
+const char* ordering_name(VertexOrdering ordering)
+{
+    static const char *names[]={"input","degeneracy","bfs","bandwidth","auto"};
+    return names[ordering];
+}
+
+
+void degeneracy_order(const fGraph &G,std::vector<int> &order)
+{
+    std::vector<int> degree(G.degree.begin(),G.degree.begin()+G.n);  // the degrees among the vertices not yet removed
+    std::vector<char> removed(G.n,false);
+    
+    order.resize(G.n);
+    for (int k=G.n-1; k>=0; k--)
+    {
+        int v=0;
+        while (removed[v])
+            v++;
+        for (int u=v+1; u<G.n; u++)
+            if (!removed[u] && (degree[u]<degree[v]))
+                v=u;
+        
+        order[k]=v;
+        removed[v]=true;
+        for (int u=0; u<G.n; u++)
+            if (!removed[u] && G.get_adj(u,v))
+                degree[u]--;
+    }
+}
+
+
+void bfs_order(const fGraph &G,std::vector<int> &order)
+{
+    std::vector<char> visited(G.n,false);
+    
+    order.clear();
+    while ((int)order.size()<G.n)
+    {
+        int root=-1;
+        for (int v=0; v<G.n; v++)
+            if (!visited[v] && ((root==-1) || (G.f[v]>G.f[root]) || ((G.f[v]==G.f[root]) && (G.degree[v]>G.degree[root]))))
+                root=v;
+        
+        visited[root]=true;
+        order.push_back(root);
+        for (size_t head=order.size()-1; head<order.size(); head++)  // order is also the queue of the search
+            for (int u=0; u<G.n; u++)
+                if (!visited[u] && G.get_adj(order[head],u))
+                {
+                    visited[u]=true;
+                    order.push_back(u);
+                }
+    }
+}
+
+
+void bandwidth_order(const fGraph &G,std::vector<int> &order)
+    // The Cuthill-McKee ordering is a breadth first search from a vertex of minimum degree,
+    // which visits the neighbors of each vertex in order of increasing degree.
+{
+    std::vector<char> visited(G.n,false);
+    std::vector<int> neighbors;
+    
+    order.clear();
+    while ((int)order.size()<G.n)
+    {
+        int root=-1;
+        for (int v=0; v<G.n; v++)
+            if (!visited[v] && ((root==-1) || (G.degree[v]<G.degree[root])))
+                root=v;
+        
+        visited[root]=true;
+        order.push_back(root);
+        for (size_t head=order.size()-1; head<order.size(); head++)
+        {
+            neighbors.clear();
+            for (int u=0; u<G.n; u++)
+                if (!visited[u] && G.get_adj(order[head],u))
+                {
+                    visited[u]=true;
+                    neighbors.push_back(u);
+                }
+            std::stable_sort(neighbors.begin(),neighbors.end(),[&](int a,int b) { return G.degree[a]<G.degree[b]; });
+            order.insert(order.end(),neighbors.begin(),neighbors.end());
+        }
+    }
+    
+    std::reverse(order.begin(),order.end());
+}
+
+
+void vertex_order(const fGraph &G,VertexOrdering ordering,std::vector<int> &order)
+    // ORDER_AUTO cannot be computed from G alone (see choose_ordering in exhaustive.h).
+{
+    switch (ordering)
+    {
+        case ORDER_DEGENERACY:
+            degeneracy_order(G,order);
+            break;
+        case ORDER_BFS:
+            bfs_order(G,order);
+            break;
+        case ORDER_BANDWIDTH:
+            bandwidth_order(G,order);
+            break;
+        default:
+            order.resize(G.n);
+            for (int v=G.n-1; v>=0; v--)
+                order[v]=v;
+    }
+}
+
+
+#endif  // ORDERING_H__CHOOXAIPHEEVAEGHAIWO
@@ -0,0 +1,53 @@
+
+// periodic.h
+// This is a C++ library for the files that the search writes periodically, such as checkpoints, statistics, and progress reports.
+// The library is contained in one header file to enable use of inline functions.
+
+// Copyright 2017, Stephen G. Hartke
+// Licensed under the GPL version 3.
+
+
+#pragma once  // for compilers that support this
+#ifndef PERIODIC_H__EEGHOOLAITHAHPHEIMOO  // include guard
+#define PERIODIC_H__EEGHOOLAITHAHPHEIMOO
+
+
+#include <string>
+#include <cstdio>  // for FILE, fopen, fclose, and rename
+#include <ctime>  // for time
+
+
+/* The periodic work is checked for at every node of the search tree, which is far more often than reading the clock is cheap,
+ * so the clock is only read once every 65536 nodes, which is a small fraction of a second.
+ *
+ * A file that is written periodically is written to a temporary file which is then renamed over it,
+ * so that a reader never sees a partial file, and a crash while writing cannot lose the previous one.
+ */
+
+
+inline
+bool periodic_check_due(unsigned long long int count,time_t next_time)
+    // Returns true if the time next_time has come, only reading the clock when count is a multiple of 65536.
+{
+    return ((count&0xFFFF)==0) && (time(NULL)>=next_time);
+}
+
+
+FILE *open_temporary_file(const std::string &filename)
+    // Opens the temporary file for writing filename, or returns NULL.
+{
+    return fopen((filename+".tmp").c_str(),"w");
+}
+
+
+bool replace_with_temporary_file(FILE *file,const std::string &filename)
+    // Closes the temporary file opened by open_temporary_file, and renames it to filename.
+    // Returns false if the file could not be written, and then filename is unchanged.
+{
+    bool ok=(fflush(file)==0);
+    ok=(fclose(file)==0) && ok;
+    return ok && (rename((filename+".tmp").c_str(),filename.c_str())==0);
+}
+
+
+#endif  // PERIODIC_H__EEGHOOLAITHAHPHEIMOO
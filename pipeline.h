@@ -0,0 +1,216 @@
+
+// pipeline.h
+// This is a C++ library for checking a stream of graphs in parallel, one graph per worker thread.
+// The library is contained in one header file to enable use of inline functions.
+
+// Copyright 2017, Stephen G. Hartke
+// Licensed under the GPL version 3.
+
+
+#pragma once  // for compilers that support this
+#ifndef PIPELINE_H__OOKAEQUAIJEEXOHNGAEV  // include guard
+#define PIPELINE_H__OOKAEQUAIJEEXOHNGAEV
+
+
+#include <string>
+#include <deque>
+#include <map>
+#include <vector>
+#include <iostream>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdio>  // for FILE, open_memstream
+#include <cstdlib>  // for free
+#include <ctime>  // for clock, clock_gettime
+#include "graphinput.h"
+
+
+/* Inputs such as the output of geng hold many small graphs, each of which is checked quickly.
+ * The pipeline has a reader thread that reads the lines of the input and skips comments,
+ * worker threads that each check one graph at a time, and the calling thread, which writes the output.
+ *
+ * Each worker writes the output for a graph to a buffer, and the writer prints the buffers in the order of the input,
+ * so the output is the same as when the graphs are checked one after another.
+ * Optionally, the buffers are printed as soon as they are finished instead.
+ * The number of graphs that have been read but not yet written is bounded, so that a slow graph does not let the buffers grow without limit.
+ *
+ * The check function is passed the index of the worker, so that each worker can keep its own data structures and reuse them for the following graphs.
+ */
+
+
+thread_local bool pipeline_worker=false;  // set in the worker threads of a pipeline
+
+
+double cpu_seconds()
+    // The CPU time used by the calling thread if it is a worker of a pipeline, and by the whole process otherwise.
+    // A worker checks one graph at a time, so clock() would also count the graphs checked by the other workers.
+{
+    if (pipeline_worker)
+    {
+        struct timespec t;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID,&t);
+        return t.tv_sec+t.tv_nsec/1e9;
+    }
+    return ((double)clock())/CLOCKS_PER_SEC;
+}
+
+
+struct PipelineJob
+{
+    unsigned long long int index;  // the position of the graph in the input, counting only the lines that are graphs
+    std::string line;  // the graph in fgraph6 format
+    std::string output;  // what the check printed
+    int value;  // what the check returned
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+class GraphPipeline
+////////////////////////////////////////////////////////////////////////////////////////
+{
+public:
+    typedef std::function<int(int worker,const std::string &line,FILE *out)> check_t;
+
+    int num_workers;
+    bool ordered;  // whether the output is written in the order of the input, or in the order the graphs are finished
+    size_t capacity;  // the maximum number of graphs that have been read but not yet written
+
+    GraphPipeline(int num_workers,bool ordered);
+
+    int run(GraphInput &in,FILE *out,const check_t &check);
+
+private:
+    std::mutex lock;  // protects everything below
+    std::condition_variable input_ready, output_ready, space_available;
+    std::deque<PipelineJob*> input;  // graphs read but not yet started by a worker
+    std::map<unsigned long long int,PipelineJob*> finished;  // graphs checked but not yet written, by index
+    unsigned long long int num_read, num_written;
+    bool end_of_input;
+
+    void read(GraphInput &in);
+    void work(int worker,const check_t &check);
+    bool next_ready() const;
+};
+
+
+GraphPipeline::GraphPipeline(int num_workers,bool ordered)
+  : // initializer list
+    num_workers(num_workers),
+    ordered(ordered),
+    capacity(16*num_workers),
+    num_read(0),
+    num_written(0),
+    end_of_input(false)
+{
+}
+
+
+void GraphPipeline::read(GraphInput &in)
+    // Run by the reader thread.
+{
+    const char *line;
+    size_t length;
+    while (in.next_graph(line,length))  // skips comments and short lines
+    {
+        PipelineJob *job=new PipelineJob;
+        job->line.assign(line,length);  // the line of in is only valid until the next one is read
+
+        std::unique_lock<std::mutex> guard(lock);
+        space_available.wait(guard,[this]() { return num_read-num_written<capacity; });
+        job->index=num_read++;
+        input.push_back(job);
+        input_ready.notify_one();
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    end_of_input=true;
+    input_ready.notify_all();
+    output_ready.notify_all();
+}
+
+
+void GraphPipeline::work(int worker,const check_t &check)
+    // Run by each worker thread.
+{
+    pipeline_worker=true;
+
+    while (true)
+    {
+        PipelineJob *job;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            input_ready.wait(guard,[this]() { return !input.empty() || end_of_input; });
+            if (input.empty())
+                return;  // all of the graphs have been started
+            job=input.front();
+            input.pop_front();
+        }
+
+        char *buffer;
+        size_t size;
+        FILE *buffer_file=open_memstream(&buffer,&size);
+        job->value=check(worker,job->line,buffer_file);
+        fclose(buffer_file);
+        job->output.assign(buffer,size);
+        free(buffer);
+
+        std::lock_guard<std::mutex> guard(lock);
+        finished[job->index]=job;
+        output_ready.notify_one();
+    }
+}
+
+
+inline
+bool GraphPipeline::next_ready() const
+    // Whether there is a finished graph that can be written now.
+{
+    return !finished.empty() && (!ordered || (finished.begin()->first==num_written));
+}
+
+
+int GraphPipeline::run(GraphInput &in,FILE *out,const check_t &check)
+    // Checks each graph of in, and writes the output of the checks to out.
+    // Returns the value of check for the last graph of in, or 0 if there are no graphs.
+{
+    std::thread reader(&GraphPipeline::read,this,std::ref(in));
+    std::vector<std::thread> workers;
+    for (int w=0; w<num_workers; w++)
+        workers.push_back(std::thread(&GraphPipeline::work,this,w,std::cref(check)));
+
+    int value=0;
+    unsigned long long int last_index=0;
+    while (true)
+    {
+        PipelineJob *job;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            output_ready.wait(guard,[this]() { return next_ready() || (end_of_input && (num_written==num_read)); });
+            if (!next_ready())
+                break;  // every graph has been written
+            job=finished.begin()->second;
+            finished.erase(finished.begin());
+            num_written++;
+            space_available.notify_one();
+        }
+
+        fwrite(job->output.data(),1,job->output.size(),out);
+        if (job->index>=last_index)
+        {
+            last_index=job->index;
+            value=job->value;
+        }
+        delete job;
+    }
+
+    reader.join();
+    for (int w=0; w<num_workers; w++)
+        workers[w].join();
+
+    return value;
+}
+
+
+#endif  // PIPELINE_H__OOKAEQUAIJEEXOHNGAEV
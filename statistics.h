@@ -0,0 +1,216 @@
+
+// statistics.h
+// This is a C++ library for collecting statistics about the search for a bad list assignment.
+// The library is contained in one header file to enable use of inline functions.
+
+// Copyright 2017, Stephen G. Hartke
+// Licensed under the GPL version 3.
+
+
+#pragma once  // for compilers that support this
+#ifndef STATISTICS_H__AEPHAIVEIMOHSHEEJOOX  // include guard
+#define STATISTICS_H__AEPHAIVEIMOHSHEEJOOX
+
+
+#include <vector>
+#include <string>
+#include <cstdio>  // for FILE and fprintf
+#include <ctime>  // for time
+#include "periodic.h"
+
+
+/* ListAssignment takes a statistics policy as a template parameter, and calls it at each event of the search.
+ * NoStatistics does nothing, and its empty inline functions are compiled away, so the search without statistics has no overhead.
+ * SearchStatistics counts the events, and periodically writes a snapshot of the counts to a file.
+ *
+ * The snapshot is a text file with one counter per line: the name of the counter followed by its values.
+ * Counters indexed by the level of the stack (ie, the number of colorability classes below) or by a size list the values from index 0 up.
+ * The file is replaced by renaming a temporary file, so a reader never sees a partial snapshot (see periodic.h).
+ */
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+struct NoStatistics
+////////////////////////////////////////////////////////////////////////////////////////
+{
+    static const bool enabled=false;
+    
+    void set_output(const std::string &,int) {}
+    void node(int) {}
+    void feasibility_check(int,bool) {}
+    void coloring_backtrack() {}
+    void pushed_class(int,int) {}
+    void small_pot_prune(int) {}
+    bool snapshot_due(unsigned long long int) { return false; }
+    void write_snapshot() {}
+    void add(const NoStatistics &) {}
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+class SearchStatistics
+////////////////////////////////////////////////////////////////////////////////////////
+{
+public:
+    static const bool enabled=true;  // the search also reports its diagnostics, such as the size of the stack
+
+    std::vector<unsigned long long int> nodes;  // indexed by level
+    std::vector<unsigned long long int> feasibility_checks;  // indexed by level
+    std::vector<unsigned long long int> feasible;  // indexed by level; the checks that found a feasible coloring
+    unsigned long long int coloring_backtracks;  // the backtracking steps in find_feasible_coloring
+    std::vector<unsigned long long int> class_sizes;  // indexed by the number of vertices in a colorability class that was pushed
+    std::vector<unsigned long long int> multiplicities;  // indexed by the number of times it was pushed
+    std::vector<unsigned long long int> small_pot_prunes;  // indexed by level
+
+    std::string filename;  // where snapshots are written
+    int interval;  // the number of seconds between snapshots
+    time_t start_time, next_time;
+
+    SearchStatistics();
+
+    void set_output(const std::string &filename,int interval);
+    void node(int level);
+    void feasibility_check(int level,bool feasible);
+    void coloring_backtrack();
+    void pushed_class(int size,int multiplicity);
+    void small_pot_prune(int level);
+    bool snapshot_due(unsigned long long int count);
+    void write_snapshot();
+    void add(const SearchStatistics &other);
+
+private:
+    static void increment(std::vector<unsigned long long int> &counter,int i);
+    static void write_counter(FILE *file,const char *name,const std::vector<unsigned long long int> &counter);
+};
+
+
+SearchStatistics::SearchStatistics()
+  : // initializer list
+    coloring_backtracks(0),
+    interval(60),
+    start_time(time(NULL)),
+    next_time(start_time+interval)
+{
+}
+
+
+void SearchStatistics::set_output(const std::string &filename,int interval)
+{
+    this->filename=filename;
+    this->interval=interval;
+    next_time=time(NULL)+interval;
+}
+
+
+inline
+void SearchStatistics::increment(std::vector<unsigned long long int> &counter,int i)
+{
+    if (i>=(int)counter.size())
+        counter.resize(i+1,0);
+    counter[i]++;
+}
+
+
+inline
+void SearchStatistics::node(int level)
+{
+    increment(nodes,level);
+}
+
+
+inline
+void SearchStatistics::feasibility_check(int level,bool feasible)
+{
+    increment(feasibility_checks,level);
+    if (feasible)
+        increment(this->feasible,level);
+}
+
+
+inline
+void SearchStatistics::coloring_backtrack()
+{
+    coloring_backtracks++;
+}
+
+
+inline
+void SearchStatistics::pushed_class(int size,int multiplicity)
+{
+    increment(class_sizes,size);
+    increment(multiplicities,multiplicity);
+}
+
+
+inline
+void SearchStatistics::small_pot_prune(int level)
+{
+    increment(small_pot_prunes,level);
+}
+
+
+inline
+bool SearchStatistics::snapshot_due(unsigned long long int count)
+{
+    return !filename.empty() && periodic_check_due(count,next_time);
+}
+
+
+void SearchStatistics::write_counter(FILE *file,const char *name,const std::vector<unsigned long long int> &counter)
+{
+    fprintf(file,"%s",name);
+    for (size_t i=0; i<counter.size(); i++)
+        fprintf(file," %llu",counter[i]);
+    fprintf(file,"\n");
+}
+
+
+void SearchStatistics::write_snapshot()
+{
+    next_time=time(NULL)+interval;
+    if (filename.empty())
+        return;
+
+    FILE *file=open_temporary_file(filename);
+    if (file==NULL)
+    {
+        printf("Could not write statistics to %s!\n",filename.c_str());
+        return;
+    }
+
+    unsigned long long int total_nodes=0;
+    for (size_t i=0; i<nodes.size(); i++)
+        total_nodes+=nodes[i];
+
+    fprintf(file,"elapsed_seconds %ld\n",(long)(time(NULL)-start_time));
+    fprintf(file,"total_nodes %llu\n",total_nodes);
+    write_counter(file,"nodes",nodes);
+    write_counter(file,"feasibility_checks",feasibility_checks);
+    write_counter(file,"feasible",feasible);
+    fprintf(file,"coloring_backtracks %llu\n",coloring_backtracks);
+    write_counter(file,"class_sizes",class_sizes);
+    write_counter(file,"multiplicities",multiplicities);
+    write_counter(file,"small_pot_prunes",small_pot_prunes);
+
+    replace_with_temporary_file(file,filename);
+}
+
+
+void SearchStatistics::add(const SearchStatistics &other)
+    // Adds the counts of other, which is used to combine the statistics of the threads.
+{
+    std::vector<unsigned long long int> *counter[]={&nodes,&feasibility_checks,&feasible,&class_sizes,&multiplicities,&small_pot_prunes};
+    const std::vector<unsigned long long int> *other_counter[]={&other.nodes,&other.feasibility_checks,&other.feasible,
+                                                                &other.class_sizes,&other.multiplicities,&other.small_pot_prunes};
+    for (int c=0; c<6; c++)
+    {
+        if (counter[c]->size()<other_counter[c]->size())
+            counter[c]->resize(other_counter[c]->size(),0);
+        for (size_t i=0; i<other_counter[c]->size(); i++)
+            (*counter[c])[i]+=(*other_counter[c])[i];
+    }
+    coloring_backtracks+=other.coloring_backtracks;
+}
+
+
+#endif  // STATISTICS_H__AEPHAIVEIMOHSHEEJOOX
@@ -14,66 +14,126 @@
 
 #include <vector>
 #include "bitarray.h"
+#include "neighborhood.h"
 
 
+template <typename bitarray_t>
 struct LayerStruct
 {
-    bitarray layer_universe;  // set of all vertices on this layer
-    bitarray layer_subset;    // subset of layer_universe that is currently chosen
-    bitarray union_universe;  // union of the universe of this and all previous layers
-    bitarray union_subset;    // union of the subset of this and all previous layers; this is the entire vertex set of the generated connected subgraph
+    bitarray_t layer_universe;  // set of all vertices on this layer
+    bitarray_t layer_subset;    // subset of layer_universe that is currently chosen
+    bitarray_t union_universe;  // union of the universe of this and all previous layers
+    bitarray_t union_subset;    // union of the subset of this and all previous layers; this is the entire vertex set of the generated connected subgraph
 };
 
 
+template <typename bitarray_t>
+class SubgraphUndoLog;
+
+
+template <typename bitarray_t>
 class ConnectedSubgraph
 {
 public:
     int n;  // number of vertices in the whole graph
-    const std::vector<bitarray> &neighbors;  // adjacencies in the graph
+    const NeighborhoodTable<bitarray_t> &neighborhood;  // adjacencies in the graph
     int root;  // the root vertex
-    bitarray eligible_vertices;  // the vertices that are eligible to be in the subgraph
+    bitarray_t eligible_vertices;  // the vertices that are eligible to be in the subgraph
     
-    std::vector<LayerStruct> layer;  // the layers
+    std::vector<LayerStruct<bitarray_t> > layer;  // the layers
     int cur_layer;  // the current (and last) layer; thus there are cur_layer+1 total layers
     
+    // Bookkeeping for the undo log; see SubgraphUndoLog below.
+    unsigned long long int undo_frame;  // the frame of the undo log in which this generator's state was last saved
+    int undo_low;  // in that frame, the layers undo_low up through the saved cur_layer have been saved
+    
 // methods:
-    ConnectedSubgraph(int n, const std::vector<bitarray> &neighbors);
+    ConnectedSubgraph(int n, const NeighborhoodTable<bitarray_t> &neighborhood);
     ConnectedSubgraph(const ConnectedSubgraph &other);
     
-    void initialize(int root, bitarray eligible_vertices);
+    void initialize(int root, bitarray_t eligible_vertices);
     void copy_from(const ConnectedSubgraph &S);
-    int next(const bitarray additional_constraints);
+    int next(const bitarray_t additional_constraints, SubgraphUndoLog<bitarray_t> *log=NULL);
+};
+
+
+/* The undo log records the changes made to a set of subgraph generators, so that they can be restored on backtracking.
+ * A frame of the log corresponds to a level of the colorability class stack.
+ * Within a frame, the first change to a generator saves its cur_layer and eligible_vertices,
+ * and each layer is saved before it is first modified.
+ * Layers above the saved cur_layer are not in use, and so are never saved.
+ * Thus the log holds at most n+1 records per generator per frame, and only generators that are actually advanced are recorded.
+ */
+
+template <typename bitarray_t>
+struct SubgraphUndoRecord
+{
+    int generator;  // the root of the generator, which is its index
+    int index;  // the layer that was saved, or -1 if this record saves the rest of the generator's state
+    LayerStruct<bitarray_t> layer;
+    int cur_layer;
+    bitarray_t eligible_vertices;
+    unsigned long long int undo_frame;
+    int undo_low;
+};
+
+
+template <typename bitarray_t>
+class SubgraphUndoLog
+{
+public:
+    std::vector<SubgraphUndoRecord<bitarray_t> > record;
+    unsigned long long int frame;  // the current frame
+    unsigned long long int last_frame;  // frames are never reused, so that stale bookkeeping in a generator cannot match
+    
+    SubgraphUndoLog();
+    
+    size_t size() const;
+    void clear();
+    unsigned long long int new_frame();
+    void save_state(ConnectedSubgraph<bitarray_t> &S);
+    void save_layers_down_to(ConnectedSubgraph<bitarray_t> &S, int i);
+    void restore(std::vector<ConnectedSubgraph<bitarray_t> > &generator, size_t mark) const;
+    void undo(std::vector<ConnectedSubgraph<bitarray_t> > &generator, size_t mark);
 };
 
 
-ConnectedSubgraph::ConnectedSubgraph(int n, const std::vector<bitarray> &neighbors)
+template <typename bitarray_t>
+ConnectedSubgraph<bitarray_t>::ConnectedSubgraph(int n, const NeighborhoodTable<bitarray_t> &neighborhood)
   : // initializer list
     n(n),
-    neighbors(neighbors)
+    neighborhood(neighborhood),
+    undo_frame(0),
+    undo_low(0)
 {
     //printf("ConnectedSubgraph constructor, n and neighbors set\n");
     layer.resize(n);  // there cannot be more than n layers
 }
 
 
-ConnectedSubgraph::ConnectedSubgraph(const ConnectedSubgraph &other)
+template <typename bitarray_t>
+ConnectedSubgraph<bitarray_t>::ConnectedSubgraph(const ConnectedSubgraph &other)
     // copy constructor, used in initialization of vectors of these objects
   : // intialization list
     n(other.n),
-    neighbors(other.neighbors),
+    neighborhood(other.neighborhood),
     root(other.root),
     eligible_vertices(other.eligible_vertices),
     layer(other.layer),
-    cur_layer(other.cur_layer)
+    cur_layer(other.cur_layer),
+    undo_frame(0),
+    undo_low(0)
 {
     //printf("ConnectedSubgraph copy constructor\n");
 }
 
 
-void ConnectedSubgraph::initialize(int root, bitarray eligible_vertices)
+template <typename bitarray_t>
+void ConnectedSubgraph<bitarray_t>::initialize(int root, bitarray_t eligible_vertices)
 {
     this->root=root;
     this->eligible_vertices=eligible_vertices;
+    undo_frame=0;  // not saved in any frame
     
     /*/
     printf("ConnectedSubgraph initialize, root=%2d, eligible_vertices=",root);
@@ -86,12 +146,13 @@ void ConnectedSubgraph::initialize(int root, bitarray eligible_vertices)
     layer[cur_layer].layer_universe=
     layer[cur_layer].union_universe=
     layer[cur_layer].union_subset=  // note that we do this to avoid an "else" in next()
-        1<<root;
+        (bitarray_t)1<<root;
     predecessor_of_first_subset(layer[cur_layer].layer_subset,layer[cur_layer].layer_universe);
 }
 
+template <typename bitarray_t>
 inline
-void ConnectedSubgraph::copy_from(const ConnectedSubgraph &S)
+void ConnectedSubgraph<bitarray_t>::copy_from(const ConnectedSubgraph &S)
 {
     // We assume that n and neighbors are the same for S and this object.
     // We copy the rest of the values.
@@ -108,8 +169,9 @@ void ConnectedSubgraph::copy_from(const ConnectedSubgraph &S)
     }
 }
 
+template <typename bitarray_t>
 inline
-int ConnectedSubgraph::next(const bitarray additional_constraints)
+int ConnectedSubgraph<bitarray_t>::next(const bitarray_t additional_constraints, SubgraphUndoLog<bitarray_t> *log)
     // Generate the next connected subgraph, in "decreasing" order.
     // Note that the algorithm must correctly handle vertices in the set that were previously eligible which are now not.
     // The additional_constraints parameter gives a way to remove eligible vertices.
@@ -117,6 +179,7 @@ int ConnectedSubgraph::next(const bitarray additional_constraints)
     // Thus, the new set of eligible vertices is always a subset of the previous set of eligible vertices.
     // We *do* generate the singleton subset consisting solely of the root.
     // Note that if the root is not an eligible vertex, then no subgraphs are generated.
+    // If log is not NULL, then the changes to this generator are recorded in log so they can be undone.
 {
     /*
     printf("ConnectedSubgraph::next()  cur_layer=%2d\n",cur_layer);
@@ -137,6 +200,9 @@ int ConnectedSubgraph::next(const bitarray additional_constraints)
     }
     //*/
     
+    if (log!=NULL)
+        log->save_state(*this);  // this must happen before any changes
+    
     // We change our set of eligible vertices to incorporate the new constraints.
     eligible_vertices&=additional_constraints;
     
@@ -155,6 +221,9 @@ int ConnectedSubgraph::next(const bitarray additional_constraints)
     }
     cur_layer=i;
     
+    if (log!=NULL)
+        log->save_layers_down_to(*this,cur_layer);  // all layers from here up may be overwritten
+    
     /*
     printf("i=%d\n",i);
     printf("Trying to advance layer %d\n",cur_layer);
@@ -175,6 +244,9 @@ int ConnectedSubgraph::next(const bitarray additional_constraints)
             // If we have backed up to the root layer, then we are done, since we must have advanced to the empty subset on layer 0.
             // cur_layer<0 should only happen if the root is ineligible.
             return false;
+        
+        if (log!=NULL)
+            log->save_layers_down_to(*this,cur_layer);
     }
     
     /*
@@ -192,36 +264,14 @@ int ConnectedSubgraph::next(const bitarray additional_constraints)
     
     // We have advanced to the next subset for cur_layer.
     // We now expand to the next layers, growing layer by layer until we fill the connected component.
-    bitarray mask;
     while (true)
     {
         // Compute layer[cur_layer+1].layer_universe for the next layer.
         // This will be all vertices that are not in layer[cur_layer].union_universe that are adjacent to a vertex in layer[cur_layer].layer_subset.
-        layer[cur_layer+1].layer_universe=0;
-        mask=1<<(n-1);
-        for (int i=n-1; i>=0; i--)
-        {
-            /*
-            printf("i=%2d, mask=",i);
-            print_binary(mask,n);
-            printf("  (layer[cur_layer].layer_subset&mask)=");
-            print_binary(layer[cur_layer].layer_subset&mask,n);
-            printf("\n");
-            //*/
-            
-            // We add the appropriate neighbors of vertex i to the next layer's universe.
-            
-            layer[cur_layer+1].layer_universe |= 
-                ( (((layer[cur_layer].layer_subset&mask)==0)-1)  
-                        // If i is set in layer[cur_layer].layer_subset, then this gives the all 1s vector.  Otherwise, it is 0.
-                 &(
-                    neighbors[i] &                        // the neighbors of i
-                    (~layer[cur_layer].union_universe) &  // that are not already in a layer
-                    eligible_vertices                     // and are eligible
-                  ) 
-                );
-            mask>>=1;
-        }
+        layer[cur_layer+1].layer_universe=
+            neighborhood.neighborhood(layer[cur_layer].layer_subset) &  // the neighbors of the vertices in this layer
+            (~layer[cur_layer].union_universe) &                         // that are not already in a layer
+            eligible_vertices;                                           // and are eligible
         
         if (first_subset(layer[cur_layer+1].layer_subset,
                          layer[cur_layer+1].layer_universe))
@@ -262,4 +312,111 @@ int ConnectedSubgraph::next(const bitarray additional_constraints)
 }
 
 
+template <typename bitarray_t>
+SubgraphUndoLog<bitarray_t>::SubgraphUndoLog()
+  : // initialization list
+    frame(1),
+    last_frame(1)  // a generator with undo_frame==0 has never been saved
+{
+}
+
+
+template <typename bitarray_t>
+inline
+size_t SubgraphUndoLog<bitarray_t>::size() const
+{
+    return record.size();
+}
+
+
+template <typename bitarray_t>
+void SubgraphUndoLog<bitarray_t>::clear()
+{
+    record.clear();
+    new_frame();  // frames are not reset, so that no generator can have a matching undo_frame
+}
+
+
+template <typename bitarray_t>
+inline
+unsigned long long int SubgraphUndoLog<bitarray_t>::new_frame()
+{
+    frame=++last_frame;
+    return frame;
+}
+
+
+template <typename bitarray_t>
+inline
+void SubgraphUndoLog<bitarray_t>::save_state(ConnectedSubgraph<bitarray_t> &S)
+    // Saves the state of S other than its layers, if this is the first change to S in this frame.
+{
+    if (S.undo_frame==frame)
+        return;  // already saved
+    
+    SubgraphUndoRecord<bitarray_t> r;
+    r.generator=S.root;
+    r.index=-1;
+    r.cur_layer=S.cur_layer;
+    r.eligible_vertices=S.eligible_vertices;
+    r.undo_frame=S.undo_frame;
+    r.undo_low=S.undo_low;
+    record.push_back(r);
+    
+    S.undo_frame=frame;
+    S.undo_low=S.cur_layer+1;  // no layers saved yet
+}
+
+
+template <typename bitarray_t>
+inline
+void SubgraphUndoLog<bitarray_t>::save_layers_down_to(ConnectedSubgraph<bitarray_t> &S, int i)
+    // Saves the layers of S from i up that have not yet been saved in this frame.
+    // save_state(S) must have been called already in this frame.
+{
+    while (S.undo_low>i)
+    {
+        S.undo_low--;
+        
+        SubgraphUndoRecord<bitarray_t> r;
+        r.generator=S.root;
+        r.index=S.undo_low;
+        r.layer=S.layer[S.undo_low];
+        record.push_back(r);
+    }
+}
+
+
+template <typename bitarray_t>
+void SubgraphUndoLog<bitarray_t>::restore(std::vector<ConnectedSubgraph<bitarray_t> > &generator, size_t mark) const
+    // Restores generator to its state when the log had size mark, by replaying the records in reverse.
+    // The log itself is unchanged, so this can be applied to a copy of the generators.
+{
+    for (size_t k=record.size(); k>mark; k--)
+    {
+        const SubgraphUndoRecord<bitarray_t> &r=record[k-1];
+        ConnectedSubgraph<bitarray_t> &S=generator[r.generator];
+        
+        if (r.index>=0)
+            S.layer[r.index]=r.layer;
+        else
+        {
+            S.cur_layer=r.cur_layer;
+            S.eligible_vertices=r.eligible_vertices;
+            S.undo_frame=r.undo_frame;
+            S.undo_low=r.undo_low;
+        }
+    }
+}
+
+
+template <typename bitarray_t>
+inline
+void SubgraphUndoLog<bitarray_t>::undo(std::vector<ConnectedSubgraph<bitarray_t> > &generator, size_t mark)
+{
+    restore(generator,mark);
+    record.resize(mark);
+}
+
+
 #endif  // SUBGRAPH_H__HEERAYOOPUWOOXUKOONO
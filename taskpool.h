@@ -0,0 +1,220 @@
+
+// taskpool.h
+// This is a C++ library for sharing the search for bad list assignments between threads.
+// The library is contained in one header file to enable use of inline functions.
+
+// Copyright 2017, Stephen G. Hartke
+// Licensed under the GPL version 3.
+
+
+#pragma once  // for compilers that support this
+#ifndef TASKPOOL_H__OOPHEIKAHCHEEXAEMOHB  // include guard
+#define TASKPOOL_H__OOPHEIKAHCHEEXAEMOHB
+
+
+#include <vector>
+#include <deque>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include "bitarray.h"
+#include "colorabilityclass.h"
+
+
+/* The search tree is split at the colorability class stack.
+ * A task is the continuation of one level of the stack: the colorability classes below that level are fixed,
+ * and the task generates the remaining subgraphs for that level (and searches below each of them).
+ * The state of the level (L, eligible vertices, and the subgraph generators as they were at that level) is all that is needed to continue.
+ *
+ * Load is balanced by work stealing.  Each thread has its own deque of tasks.
+ * When a thread is idle and there are no queued tasks, a busy thread donates the shallowest level of its stack
+ * (which should be the largest piece of remaining work) to its own deque, and stops searching that level itself.
+ * Idle threads take tasks from their own deque first, and otherwise steal the oldest task from another thread's deque.
+ */
+
+
+template <typename bitarray_t>
+////////////////////////////////////////////////////////////////////////////////////////
+struct SearchTask
+////////////////////////////////////////////////////////////////////////////////////////
+{
+    int level;  // the level of the stack at which the task continues
+    std::vector<bitarray_t> colorability_class;  // the colorability classes of the levels below level
+    std::vector<ConnectedSubgraph<bitarray_t> > generator;  // the state of the subgraph generators at level
+    SubgraphUndoLog<bitarray_t> undo_log;  // not used, but info needs one
+    ColorabilityClassInfo<bitarray_t> info;  // the state of the stack at level
+
+    SearchTask(int n,const std::vector<bitarray_t> &neighbors,const NeighborhoodTable<bitarray_t> &neighborhood)
+      : // initialization list
+        level(0),
+        generator(n,ConnectedSubgraph<bitarray_t>(n,neighborhood)),
+        info(n,neighbors,generator,undo_log)
+    {
+    }
+};
+
+
+template <typename Task>
+////////////////////////////////////////////////////////////////////////////////////////
+class TaskPool
+////////////////////////////////////////////////////////////////////////////////////////
+{
+public:
+    int num_threads;
+    std::vector<std::deque<Task*> > tasks;  // one deque per thread
+    std::vector<std::mutex> tasks_lock;  // protects the deque with the same index
+
+    std::atomic<int> idle;  // number of threads waiting for a task
+    std::atomic<int> queued;  // number of tasks in all of the deques
+    std::atomic<long> outstanding;  // number of tasks that are queued or being searched; the search is over when this is 0
+    std::atomic<bool> stop;  // set when a bad list assignment is found, so that all threads stop
+    std::atomic<long> num_donations, num_steals;
+
+    std::mutex wait_lock;  // used only for sleeping while waiting for a task
+    std::condition_variable wait_cv;
+
+    TaskPool(int num_threads);
+    ~TaskPool();
+
+    bool hungry() const;
+    bool stop_requested() const;
+    void donate(int thread,Task *task);
+    bool get_task(int thread,Task *&task);
+    void finish_task();
+    bool report_bad_list();
+};
+
+
+template <typename Task>
+TaskPool<Task>::TaskPool(int num_threads)
+  : // initialization list
+    num_threads(num_threads),
+    tasks(num_threads),
+    tasks_lock(num_threads),
+    idle(0),
+    queued(0),
+    outstanding(1),  // the root of the search tree is searched by thread 0 without being queued
+    stop(false),
+    num_donations(0),
+    num_steals(0)
+{
+}
+
+
+template <typename Task>
+TaskPool<Task>::~TaskPool()
+{
+    // Tasks remain only if the search was stopped early.
+    for (int i=num_threads-1; i>=0; i--)
+        for (size_t j=0; j<tasks[i].size(); j++)
+            delete tasks[i][j];
+}
+
+
+template <typename Task>
+inline
+bool TaskPool<Task>::hungry() const
+    // Returns true if there are idle threads that cannot find a queued task.
+    // This is called for every node of the search tree, so we only use relaxed loads.
+{
+    return idle.load(std::memory_order_relaxed) > queued.load(std::memory_order_relaxed);
+}
+
+
+template <typename Task>
+inline
+bool TaskPool<Task>::stop_requested() const
+{
+    return stop.load(std::memory_order_relaxed);
+}
+
+
+template <typename Task>
+void TaskPool<Task>::donate(int thread,Task *task)
+{
+    outstanding++;  // must be incremented before the task can be taken and finished
+    {
+        std::lock_guard<std::mutex> guard(tasks_lock[thread]);
+        tasks[thread].push_back(task);
+    }
+    queued++;
+    num_donations++;
+    wait_cv.notify_one();
+}
+
+
+template <typename Task>
+bool TaskPool<Task>::get_task(int thread,Task *&task)
+    // Waits until a task is available, and returns it in task.
+    // Returns false if the search is over, either because all tasks are finished or because a bad list assignment was found.
+{
+    bool waiting=false;
+
+    while (true)
+    {
+        if (stop_requested() || outstanding==0)
+            break;
+
+        // We first try our own deque, taking the most recently donated task.
+        // Otherwise we steal the oldest task from another thread's deque.
+        for (int i=0; i<num_threads; i++)
+        {
+            int victim=(thread+i)%num_threads;
+            std::lock_guard<std::mutex> guard(tasks_lock[victim]);
+            if (!tasks[victim].empty())
+            {
+                if (victim==thread)
+                {
+                    task=tasks[victim].back();
+                    tasks[victim].pop_back();
+                }
+                else
+                {
+                    task=tasks[victim].front();
+                    tasks[victim].pop_front();
+                    num_steals++;
+                }
+                queued--;
+                if (waiting)
+                    idle--;
+                return true;
+            }
+        }
+
+        if (!waiting)
+        {
+            idle++;  // this asks the busy threads to donate a task
+            waiting=true;
+        }
+
+        std::unique_lock<std::mutex> wait_guard(wait_lock);
+        wait_cv.wait_for(wait_guard,std::chrono::milliseconds(1));
+    }
+
+    if (waiting)
+        idle--;
+    return false;
+}
+
+
+template <typename Task>
+void TaskPool<Task>::finish_task()
+{
+    if (--outstanding==0)
+        wait_cv.notify_all();  // wake up the idle threads so that they can exit
+}
+
+
+template <typename Task>
+bool TaskPool<Task>::report_bad_list()
+    // Stops all of the threads.
+    // Returns true only for the first thread that reports a bad list assignment, which is the one that should print it.
+{
+    bool first=!stop.exchange(true);
+    wait_cv.notify_all();
+    return first;
+}
+
+
+#endif  // TASKPOOL_H__OOPHEIKAHCHEEXAEMOHB
@@ -0,0 +1,70 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include "compositions.h"
+#include "alontarsi.h"
+
+// We compare the Alon-Tarsi search with the coefficients from GraphPolynomial, on random graphs.
+// The search should succeed exactly when some monomial with exponents below f has a nonzero coefficient,
+// and the difference it finds should be that coefficient up to sign.
+
+int main()
+{
+    fGraph G, H;
+    int num_found=0, num_wrong=0;
+
+    srand(1);
+    for (int trial=0; trial<2000; trial++)
+    {
+        int n=2+rand()%6;
+        G.allocate(n);
+        for (int j=0; j<n; j++)
+            for (int i=0; i<j; i++)
+                G.set_adj_sorted(i,j,(rand()%3)!=0);
+
+        // we choose f with sum(f[i]-1) equal to the number of edges plus diff
+        int num_edges=G.get_number_of_edges();
+        int diff=rand()%3;
+        for (int i=0; i<n; i++)
+            G.f[i]=1;
+        for (int k=num_edges+diff; k>0; k--)
+            G.f[rand()%n]++;
+
+        bool expected=false;
+        Compositions C;  // first() does not clear the entries left by a longer composition
+        C.first(diff,n);
+        do
+        {
+            H.copy_from(G);
+            bool valid=true;
+            for (int i=0; i<n; i++)
+            {
+                H.f[i]-=C.x[i];
+                valid=valid && (H.f[i]>=1);
+            }
+            if (valid && (GraphPolynomial(H).coefficient()!=0))
+                expected=true;
+        } while (!expected && (diff>0) && C.next());  // next() assumes diff>0, as in the driver
+
+        AlonTarsi alon_tarsi(G);
+        bool found=alon_tarsi.search();
+        bool wrong=(found!=expected);
+        if (found)
+        {
+            num_found++;
+            H.copy_from(G);
+            for (int i=0; i<n; i++)
+                H.f[i]=alon_tarsi.outdegree[i]+1;
+            coefficient_t coeff=GraphPolynomial(H).coefficient();
+            wrong=wrong || ((coeff!=alon_tarsi.difference) && (coeff!=-alon_tarsi.difference));
+        }
+
+        if (wrong)
+        {
+            num_wrong++;
+            printf("trial=%d n=%d expected=%d found=%d difference=%s\n",trial,n,expected,found,
+                   coefficient_to_string(alon_tarsi.difference).c_str());
+        }
+    }
+    printf("found=%d wrong=%d\n",num_found,num_wrong);
+    return (num_wrong!=0);
+}
@@ -2,15 +2,14 @@
 #include <cstdio>
 #include "bitarray.h"
 
-int main()
+template <typename bitarray_t>
+void test_subsets(bitarray_t universe, int width)
 {
-    bitarray x,universe;
-    int width=7;
+    bitarray_t x;
     int count;
     
-    printf("sizeof(bitarray)=%lu bits\n\n",sizeof(bitarray)*8);
+    printf("sizeof(bitarray)=%lu bits\n\n",sizeof(bitarray_t)*8);
     
-    universe=38+16;
     printf(" univ= ");
     print_binary(universe,width);
     printf("\n");
@@ -44,4 +43,15 @@ int main()
         //    break;
     };
     
+    printf("popcount=%d lowest_bit=%d highest_bit=%d\n\n",popcount(universe),lowest_bit(universe),highest_bit(universe));
+}
+
+int main()
+{
+    test_subsets<bitarray>(38+16,7);
+    
+    // The subsets should be the same for all widths, including across the boundary between words.
+    test_subsets<uint32_t>(38+16,7);
+    test_subsets<bitarray128>(((bitarray128)(38+16))<<61,70);
+    test_subsets<MultiWordBitArray<2> >(((MultiWordBitArray<2>)(38+16))<<61,70);
 }
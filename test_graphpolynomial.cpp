@@ -0,0 +1,75 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <map>
+#include "graphpolynomial.h"
+
+// We compare the coefficients from GraphPolynomial with a direct expansion of the product over the edges, on random graphs.
+
+coefficient_t expand(const fGraph &G)
+{
+    std::map<std::vector<int>,coefficient_t> terms, next;
+    terms[std::vector<int>(G.n,0)]=1;
+    for (int j=0; j<G.n; j++)
+        for (int i=0; i<j; i++)
+            if (G.get_adj_sorted(i,j))
+            {
+                next.clear();
+                for (std::map<std::vector<int>,coefficient_t>::iterator it=terms.begin(); it!=terms.end(); ++it)
+                {
+                    std::vector<int> exponents=it->first;
+                    exponents[i]++;
+                    next[exponents]+=it->second;
+                    exponents[i]--;
+                    exponents[j]++;
+                    next[exponents]-=it->second;
+                }
+                terms.swap(next);
+            }
+
+    std::vector<int> target(G.n);
+    for (int i=0; i<G.n; i++)
+        target[i]=G.f[i]-1;
+    return terms.count(target) ? terms[target] : 0;
+}
+
+int main()
+{
+    fGraph G;
+    int num_nonzero=0, num_wrong=0;
+
+    srand(1);
+    for (int trial=0; trial<2000; trial++)
+    {
+        int n=2+rand()%6;
+        G.allocate(n);
+        for (int j=0; j<n; j++)
+            for (int i=0; i<j; i++)
+                G.set_adj_sorted(i,j,(rand()%3)!=0);
+
+        // we choose f with sum(f[i]-1) equal to the number of edges
+        int num_edges=G.get_number_of_edges();
+        for (int i=0; i<n; i++)
+            G.f[i]=1;
+        for (int k=num_edges; k>0; k--)
+            G.f[rand()%n]++;
+
+        GraphPolynomial polynomial(G);
+        coefficient_t expected=expand(G);
+        coefficient_t coeff=polynomial.coefficient();
+        unsigned long long int coeff_mod=polynomial.coefficient_mod(1000003);
+        coefficient_t expected_mod=expected%1000003;
+        if (expected_mod<0)
+            expected_mod+=1000003;
+
+        if (expected!=0)
+            num_nonzero++;
+        if ((coeff!=expected) || (coeff_mod!=(unsigned long long int)expected_mod))
+        {
+            num_wrong++;
+            printf("trial=%d n=%d expected=%s coeff=%s coeff_mod=%llu\n",trial,n,
+                   coefficient_to_string(expected).c_str(),coefficient_to_string(coeff).c_str(),coeff_mod);
+        }
+    }
+    printf("nonzero coefficients=%d wrong=%d\n",num_nonzero,num_wrong);
+    return (num_wrong!=0);
+}
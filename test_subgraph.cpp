@@ -4,6 +4,7 @@
 #include <cstdio>  // for printf
 #include <vector>
 #include "bitarray.h"
+#include "neighborhood.h"
 #include "subgraph.h"
 #include "graph.h"
 #include "fgraph.h"
@@ -50,9 +51,10 @@ int main()
         //eligible_vertices=(1<<G.n)-1;
         //                  109876543210
         eligible_vertices=0b001001000001;
-        eligible_vertices=(1<<G.n)-1;  // all vertices are eligible
+        eligible_vertices=((bitarray)1<<G.n)-1;  // all vertices are eligible
 
-        ConnectedSubgraph S(G.n,neighbors);
+        NeighborhoodTable<bitarray> neighborhood(G.n,neighbors);
+        ConnectedSubgraph<bitarray> S(G.n,neighborhood);
         S.initialize(root,eligible_vertices);
         count=0;
         printf("Starting subgraph generation.\n");
@@ -0,0 +1,144 @@
+
+// witnesspool.h
+// This is a C++ library for reusing the feasible colorings found for the previous colorability classes on a level.
+// The library is contained in one header file to enable use of inline functions.
+
+// Copyright 2017, Stephen G. Hartke
+// Licensed under the GPL version 3.
+
+
+#pragma once  // for compilers that support this
+#ifndef WITNESSPOOL_H__EIWAHNGOOPHUTHAECAI  // include guard
+#define WITNESSPOOL_H__EIWAHNGOOPHUTHAECAI
+
+
+#include <vector>
+#include "bitarray.h"
+
+
+/* Consecutive colorability classes generated on a level usually differ in only a few vertices,
+ * and many of them have a feasible coloring, after which the search moves on to the next class on the level.
+ * A feasible coloring of the classes 0..cur_color is given by the classes below the level, which are the same for every class on the level,
+ * and by the vertices colored with cur_color.  So a feasible coloring found for a previous class on the level is also a feasible coloring
+ * of the current class if the vertices it colors with cur_color are in the current class, which is a single test of bitarrays.
+ * Those vertices are the witness of the coloring, and the last pool_size witnesses of each level are kept.
+ *
+ * The witnesses of a level are forgotten when its undo_frame changes, since each setup of a level has a new frame (see subgraph.h).
+ */
+
+
+template <typename bitarray_t>
+////////////////////////////////////////////////////////////////////////////////////////
+class WitnessPool
+////////////////////////////////////////////////////////////////////////////////////////
+{
+public:
+    static const int pool_size=4;
+    
+    bool active;  // whether the pool is used; resize sets it, and clear resets it
+    unsigned long long int hits, misses;
+    
+    WitnessPool();
+    
+    void resize(int num_levels);
+    void clear();
+    bool enabled() const;
+    bool lookup(int level,unsigned long long int undo_frame,const bitarray_t &colorability_class);
+    void insert(int level,unsigned long long int undo_frame,const bitarray_t &witness);
+
+private:
+    // These are indexed by level.
+    std::vector<unsigned long long int> frame;  // the undo_frame of the level when its witnesses were found
+    std::vector<int> num_witnesses;
+    std::vector<int> next;  // the witness that is replaced next
+    std::vector<bitarray_t> witnesses;  // indexed by level*pool_size+i
+    
+    void forget_stale(int level,unsigned long long int undo_frame);
+};
+
+
+template <typename bitarray_t>
+WitnessPool<bitarray_t>::WitnessPool()
+  : // initializer list
+    active(false),
+    hits(0),
+    misses(0)
+{
+}
+
+
+template <typename bitarray_t>
+void WitnessPool<bitarray_t>::resize(int num_levels)
+{
+    frame.assign(num_levels,0);
+    num_witnesses.assign(num_levels,0);
+    next.assign(num_levels,0);
+    witnesses.resize(num_levels*pool_size);
+    
+    active=true;
+    hits=0;
+    misses=0;
+}
+
+
+template <typename bitarray_t>
+void WitnessPool<bitarray_t>::clear()
+{
+    active=false;
+    hits=0;
+    misses=0;
+}
+
+
+template <typename bitarray_t>
+inline
+bool WitnessPool<bitarray_t>::enabled() const
+{
+    return active;
+}
+
+
+template <typename bitarray_t>
+inline
+void WitnessPool<bitarray_t>::forget_stale(int level,unsigned long long int undo_frame)
+{
+    if (frame[level]!=undo_frame)
+    {
+        frame[level]=undo_frame;
+        num_witnesses[level]=0;
+        next[level]=0;
+    }
+}
+
+
+template <typename bitarray_t>
+inline
+bool WitnessPool<bitarray_t>::lookup(int level,unsigned long long int undo_frame,const bitarray_t &colorability_class)
+    // Returns true if a witness of the level is contained in colorability_class, and so it has a feasible coloring.
+{
+    forget_stale(level,undo_frame);
+    const bitarray_t *level_witnesses=&witnesses[level*pool_size];
+    for (int i=num_witnesses[level]-1; i>=0; i--)
+        if ((level_witnesses[i] & ~colorability_class)==0)
+        {
+            hits++;
+            return true;
+        }
+    misses++;
+    return false;
+}
+
+
+template <typename bitarray_t>
+inline
+void WitnessPool<bitarray_t>::insert(int level,unsigned long long int undo_frame,const bitarray_t &witness)
+{
+    forget_stale(level,undo_frame);
+    witnesses[level*pool_size+next[level]]=witness;
+    next[level]=(next[level]+1)%pool_size;
+    if (num_witnesses[level]<pool_size)
+        num_witnesses[level]++;
+}
+
+
+#endif  // WITNESSPOOL_H__EIWAHNGOOPHUTHAECAI